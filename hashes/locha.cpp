@@ -25,20 +25,113 @@
  */
 #include "Platform.h"
 #include "Hashlib.h"
-#include <bits/stdc++.h>
-#include <functional>
-#include <iostream>
+#include "Mathmult.h"
+
 #include <algorithm>
-// shuffled prime numbers lower than 1000
-static uint16_t const S_table1[97]{
-    421, 311, 977, 331, 503, 139, 683, 907, 73, 151, 797, 83, 761, 373, 157, 71, 127, 601, 607, 881, 967, 569, 281, 353, 659, 839, 641, 41, 401, 587, 113, 13, 293, 769, 103, 809, 443, 29, 53, 599, 829, 277, 557, 523, 647, 953, 433, 457, 307, 857, 347, 193, 181, 757, 823, 383, 673, 461, 487, 137, 223, 439, 677, 109, 739, 449, 719, 701, 409, 491, 877, 971, 59, 131, 941, 349, 389, 547, 859, 197, 101, 431, 149, 367, 499, 821, 17, 251, 929, 227, 11, 379, 271, 743, 89, 241};
 
-// random shuffled prime numbers between Range of the paper(probably)
-static uint16_t const S_table2[67]{
-    2281, 2239, 2309, 2083, 2459, 2081, 2069, 2441, 2153, 2347, 2287, 2203, 2179, 2027, 2293, 2383, 2251, 2521, 2243, 2039, 2129, 2531, 2339, 2131, 2437, 2089, 2011, 2473, 2273, 2003, 2341, 2267, 2377, 2113, 2237, 2423, 2417, 2143, 2269, 2087, 2099, 2017, 2447, 2141, 2371, 2311, 2137, 2111, 2477, 2297, 2503, 2351, 2207, 2411, 2357, 2161, 2467, 2029, 2053, 2381, 2399, 2221, 2389, 2213, 2063, 2333, 2393};
+#if defined(HAVE_SSSE_3)
+  #include "Intrinsics.h"
+  #define LOCHA_IMPL_STR "ssse3"
+#else
+  #define LOCHA_IMPL_STR "portable"
+#endif
+
+// The three S-boxes, kept together so that a seeded hash can swap in
+// its own permuted copy of all of them.
+typedef struct
+{
+    uint16_t S1[97];
+    uint16_t S2[68];
+    uint16_t S3[256];
+} LOCHA_Tables;
+
+static const LOCHA_Tables locha_tables = {
+    // shuffled prime numbers lower than 1000
+    {
+        421, 311, 977, 331, 503, 139, 683, 907, 73, 151, 797, 83, 761, 373, 157, 71, 127, 601, 607, 881, 967, 569, 281, 353, 659, 839, 641, 41, 401, 587, 113, 13, 293, 769, 103, 809, 443, 29, 53, 599, 829, 277, 557, 523, 647, 953, 433, 457, 307, 857, 347, 193, 181, 757, 823, 383, 673, 461, 487, 137, 223, 439, 677, 109, 739, 449, 719, 701, 409, 491, 877, 971, 59, 131, 941, 349, 389, 547, 859, 197, 101, 431, 149, 367, 499, 821, 17, 251, 929, 227, 11, 379, 271, 743, 89, 241
+    },
+    // random shuffled prime numbers between Range of the paper(probably)
+    // sstep_conv[1] can be 67, which used to read one entry past the end
+    // of this table and land in (zeroed) padding. That entry is now
+    // explicit, so the hash doesn't depend on data layout.
+    {
+        2281, 2239, 2309, 2083, 2459, 2081, 2069, 2441, 2153, 2347, 2287, 2203, 2179, 2027, 2293, 2383, 2251, 2521, 2243, 2039, 2129, 2531, 2339, 2131, 2437, 2089, 2011, 2473, 2273, 2003, 2341, 2267, 2377, 2113, 2237, 2423, 2417, 2143, 2269, 2087, 2099, 2017, 2447, 2141, 2371, 2311, 2137, 2111, 2477, 2297, 2503, 2351, 2207, 2411, 2357, 2161, 2467, 2029, 2053, 2381, 2399, 2221, 2389, 2213, 2063, 2333, 2393, 0
+    },
+    {
+        1579, 337, 1009, 353, 541, 163, 1607, 1367, 97, 173, 1123, 1231, 797, 397, 179, 89, 149, 619, 1223, 911, 991, 1553, 311, 1373, 683, 863, 1307, 59, 431, 607, 1429, 1543, 1303, 809, 127, 827, 1423, 1489, 1109, 617, 859, 1619, 1103, 563, 673, 1657, 457, 479, 331, 1499, 367, 223, 1493, 1229, 853, 409, 1117, 487, 1289, 157, 239, 1637, 709, 1061, 1129, 467, 1567, 733, 433, 521, 907, 997, 73, 151, 1627, 373, 419, 571, 883, 1201, 113, 449, 1601, 389, 523, 839, 31, 271, 953, 241, 23, 401, 1531, 769, 1279, 1153, 257, 131, 233, 439, 193, 41, 1597, 1213, 421, 229, 661, 1259, 61, 1409, 19, 1193, 1049, 281, 1019, 1381, 821, 613, 181, 1487, 1319, 503, 967, 499, 1447, 17, 1063, 1051, 349, 811, 727, 1321, 1249, 977, 877, 11, 277, 1181, 67, 887, 283, 13, 643, 1471, 739, 109, 1031, 587, 101, 929, 829, 47, 359, 773, 677, 599, 941, 491, 53, 1093, 1091, 1187, 569, 1021, 1217, 601, 1433, 37, 857, 1523, 1327, 641, 751, 1609, 1151, 383, 1087, 1571, 1613, 823, 1583, 71, 701, 1097, 1163, 83, 269, 761, 647, 211, 1301, 1171, 227, 653, 1483, 1439, 787, 103, 167, 757, 1039, 1283, 1453, 1277, 509, 577, 463, 263, 317, 659, 347, 1427, 557, 1399, 937, 379, 547, 631, 691, 1297, 313, 139, 1069, 1361, 1559, 79, 107, 983, 919, 593, 191, 947, 43, 199, 881, 1511, 197, 1621, 29, 307, 1481, 1033, 743, 1451, 443, 1291, 1013, 1237, 719, 137, 251, 1549, 293, 971, 461, 1459
+    }
+};
+
+// Lemire's fastmod reciprocals: locha_rcp[d] = 2^64 / d, rounded up and
+// taken mod 2^64, for every possible sstep_conv[2] value (d = 0 never
+// occurs). See LOCHA_Mod().
+static const uint64_t locha_rcp[256] = {
+    UINT64_C(0x0000000000000000), UINT64_C(0x0000000000000000), UINT64_C(0x8000000000000000), UINT64_C(0x5555555555555556),
+    UINT64_C(0x4000000000000000), UINT64_C(0x3333333333333334), UINT64_C(0x2AAAAAAAAAAAAAAB), UINT64_C(0x2492492492492493),
+    UINT64_C(0x2000000000000000), UINT64_C(0x1C71C71C71C71C72), UINT64_C(0x199999999999999A), UINT64_C(0x1745D1745D1745D2),
+    UINT64_C(0x1555555555555556), UINT64_C(0x13B13B13B13B13B2), UINT64_C(0x124924924924924A), UINT64_C(0x1111111111111112),
+    UINT64_C(0x1000000000000000), UINT64_C(0x0F0F0F0F0F0F0F10), UINT64_C(0x0E38E38E38E38E39), UINT64_C(0x0D79435E50D79436),
+    UINT64_C(0x0CCCCCCCCCCCCCCD), UINT64_C(0x0C30C30C30C30C31), UINT64_C(0x0BA2E8BA2E8BA2E9), UINT64_C(0x0B21642C8590B217),
+    UINT64_C(0x0AAAAAAAAAAAAAAB), UINT64_C(0x0A3D70A3D70A3D71), UINT64_C(0x09D89D89D89D89D9), UINT64_C(0x097B425ED097B426),
+    UINT64_C(0x0924924924924925), UINT64_C(0x08D3DCB08D3DCB09), UINT64_C(0x0888888888888889), UINT64_C(0x0842108421084211),
+    UINT64_C(0x0800000000000000), UINT64_C(0x07C1F07C1F07C1F1), UINT64_C(0x0787878787878788), UINT64_C(0x0750750750750751),
+    UINT64_C(0x071C71C71C71C71D), UINT64_C(0x06EB3E45306EB3E5), UINT64_C(0x06BCA1AF286BCA1B), UINT64_C(0x0690690690690691),
+    UINT64_C(0x0666666666666667), UINT64_C(0x063E7063E7063E71), UINT64_C(0x0618618618618619), UINT64_C(0x05F417D05F417D06),
+    UINT64_C(0x05D1745D1745D175), UINT64_C(0x05B05B05B05B05B1), UINT64_C(0x0590B21642C8590C), UINT64_C(0x0572620AE4C415CA),
+    UINT64_C(0x0555555555555556), UINT64_C(0x05397829CBC14E5F), UINT64_C(0x051EB851EB851EB9), UINT64_C(0x0505050505050506),
+    UINT64_C(0x04EC4EC4EC4EC4ED), UINT64_C(0x04D4873ECADE304E), UINT64_C(0x04BDA12F684BDA13), UINT64_C(0x04A7904A7904A791),
+    UINT64_C(0x0492492492492493), UINT64_C(0x047DC11F7047DC12), UINT64_C(0x0469EE58469EE585), UINT64_C(0x0456C797DD49C342),
+    UINT64_C(0x0444444444444445), UINT64_C(0x04325C53EF368EB1), UINT64_C(0x0421084210842109), UINT64_C(0x0410410410410411),
+    UINT64_C(0x0400000000000000), UINT64_C(0x03F03F03F03F03F1), UINT64_C(0x03E0F83E0F83E0F9), UINT64_C(0x03D226357E16ECE6),
+    UINT64_C(0x03C3C3C3C3C3C3C4), UINT64_C(0x03B5CC0ED7303B5D), UINT64_C(0x03A83A83A83A83A9), UINT64_C(0x039B0AD12073615B),
+    UINT64_C(0x038E38E38E38E38F), UINT64_C(0x0381C0E070381C0F), UINT64_C(0x03759F22983759F3), UINT64_C(0x0369D0369D0369D1),
+    UINT64_C(0x035E50D79435E50E), UINT64_C(0x03531DEC0D4C77B1), UINT64_C(0x0348348348348349), UINT64_C(0x033D91D2A2067B24),
+    UINT64_C(0x0333333333333334), UINT64_C(0x0329161F9ADD3C0D), UINT64_C(0x031F3831F3831F39), UINT64_C(0x03159721ED7E7535),
+    UINT64_C(0x030C30C30C30C30D), UINT64_C(0x0303030303030304), UINT64_C(0x02FA0BE82FA0BE83), UINT64_C(0x02F149902F149903),
+    UINT64_C(0x02E8BA2E8BA2E8BB), UINT64_C(0x02E05C0B81702E06), UINT64_C(0x02D82D82D82D82D9), UINT64_C(0x02D02D02D02D02D1),
+    UINT64_C(0x02C8590B21642C86), UINT64_C(0x02C0B02C0B02C0B1), UINT64_C(0x02B9310572620AE5), UINT64_C(0x02B1DA46102B1DA5),
+    UINT64_C(0x02AAAAAAAAAAAAAB), UINT64_C(0x02A3A0FD5C5F02A4), UINT64_C(0x029CBC14E5E0A730), UINT64_C(0x0295FAD40A57EB51),
+    UINT64_C(0x028F5C28F5C28F5D), UINT64_C(0x0288DF0CAC5B3F5E), UINT64_C(0x0282828282828283), UINT64_C(0x027C45979C952050),
+    UINT64_C(0x0276276276276277), UINT64_C(0x0270270270270271), UINT64_C(0x026A439F656F1827), UINT64_C(0x02647C69456217ED),
+    UINT64_C(0x025ED097B425ED0A), UINT64_C(0x02593F69B02593F7), UINT64_C(0x0253C8253C8253C9), UINT64_C(0x024E6A171024E6A2),
+    UINT64_C(0x024924924924924A), UINT64_C(0x0243F6F0243F6F03), UINT64_C(0x023EE08FB823EE09), UINT64_C(0x0239E0D5B450239F),
+    UINT64_C(0x0234F72C234F72C3), UINT64_C(0x0230230230230231), UINT64_C(0x022B63CBEEA4E1A1), UINT64_C(0x0226B90226B90227),
+    UINT64_C(0x0222222222222223), UINT64_C(0x021D9EAD7CD391FC), UINT64_C(0x02192E29F79B4759), UINT64_C(0x0214D0214D0214D1),
+    UINT64_C(0x0210842108421085), UINT64_C(0x020C49BA5E353F7D), UINT64_C(0x0208208208208209), UINT64_C(0x0204081020408103),
+    UINT64_C(0x0200000000000000), UINT64_C(0x01FC07F01FC07F02), UINT64_C(0x01F81F81F81F81F9), UINT64_C(0x01F44659E4A42716),
+    UINT64_C(0x01F07C1F07C1F07D), UINT64_C(0x01ECC07B301ECC08), UINT64_C(0x01E9131ABF0B7673), UINT64_C(0x01E573AC901E573B),
+    UINT64_C(0x01E1E1E1E1E1E1E2), UINT64_C(0x01DE5D6E3F8868A5), UINT64_C(0x01DAE6076B981DAF), UINT64_C(0x01D77B654B82C33A),
+    UINT64_C(0x01D41D41D41D41D5), UINT64_C(0x01D0CB58F6EC0744), UINT64_C(0x01CD85689039B0AE), UINT64_C(0x01CA4B3055EE1911),
+    UINT64_C(0x01C71C71C71C71C8), UINT64_C(0x01C3F8F01C3F8F02), UINT64_C(0x01C0E070381C0E08), UINT64_C(0x01BDD2B899406F75),
+    UINT64_C(0x01BACF914C1BACFA), UINT64_C(0x01B7D6C3DDA338B3), UINT64_C(0x01B4E81B4E81B4E9), UINT64_C(0x01B2036406C80D91),
+    UINT64_C(0x01AF286BCA1AF287), UINT64_C(0x01AC5701AC5701AD), UINT64_C(0x01A98EF606A63BD9), UINT64_C(0x01A6D01A6D01A6D1),
+    UINT64_C(0x01A41A41A41A41A5), UINT64_C(0x01A16D3F97A4B01B), UINT64_C(0x019EC8E951033D92), UINT64_C(0x019C2D14EE4A101A),
+    UINT64_C(0x019999999999999A), UINT64_C(0x01970E4F80CB8728), UINT64_C(0x01948B0FCD6E9E07), UINT64_C(0x01920FB49D0E228E),
+    UINT64_C(0x018F9C18F9C18F9D), UINT64_C(0x018D3018D3018D31), UINT64_C(0x018ACB90F6BF3A9B), UINT64_C(0x01886E5F0ABB049A),
+    UINT64_C(0x0186186186186187), UINT64_C(0x0183C977AB2BEDD3), UINT64_C(0x0181818181818182), UINT64_C(0x017F405FD017F406),
+    UINT64_C(0x017D05F417D05F42), UINT64_C(0x017AD2208E0ECC36), UINT64_C(0x0178A4C8178A4C82), UINT64_C(0x01767DCE434A9B11),
+    UINT64_C(0x01745D1745D1745E), UINT64_C(0x01724287F46DEBC1), UINT64_C(0x01702E05C0B81703), UINT64_C(0x016E1F76B4337C6D),
+    UINT64_C(0x016C16C16C16C16D), UINT64_C(0x016A13CD15372905), UINT64_C(0x0168168168168169), UINT64_C(0x01661EC6A5122F91),
+    UINT64_C(0x01642C8590B21643), UINT64_C(0x01623FA7701623FB), UINT64_C(0x0160581605816059), UINT64_C(0x015E75BB8D015E76),
+    UINT64_C(0x015C9882B9310573), UINT64_C(0x015AC056B015AC06), UINT64_C(0x0158ED2308158ED3), UINT64_C(0x01571ED3C506B39B),
+    UINT64_C(0x0155555555555556), UINT64_C(0x015390948F40FEAD), UINT64_C(0x0151D07EAE2F8152), UINT64_C(0x0150150150150151),
+    UINT64_C(0x014E5E0A72F05398), UINT64_C(0x014CAB88725AF6E8), UINT64_C(0x014AFD6A052BF5A9), UINT64_C(0x0149539E3B2D066F),
+    UINT64_C(0x0147AE147AE147AF), UINT64_C(0x01460CBC7F5CF9A2), UINT64_C(0x01446F86562D9FAF), UINT64_C(0x0142D6625D51F86F),
+    UINT64_C(0x0141414141414142), UINT64_C(0x013FB013FB013FB1), UINT64_C(0x013E22CBCE4A9028), UINT64_C(0x013C995A47BABE75),
+    UINT64_C(0x013B13B13B13B13C), UINT64_C(0x013991C2C187F634), UINT64_C(0x0138138138138139), UINT64_C(0x013698DF3DE0747A),
+    UINT64_C(0x013521CFB2B78C14), UINT64_C(0x0133AE45B57BCB1F), UINT64_C(0x01323E34A2B10BF7), UINT64_C(0x0130D190130D1902),
+    UINT64_C(0x012F684BDA12F685), UINT64_C(0x012E025C04B80971), UINT64_C(0x012C9FB4D812C9FC), UINT64_C(0x012B404AD012B405),
+    UINT64_C(0x0129E4129E4129E5), UINT64_C(0x01288B01288B0129), UINT64_C(0x0127350B88127351), UINT64_C(0x0125E22708092F12),
+    UINT64_C(0x0124924924924925), UINT64_C(0x0123456789ABCDF1), UINT64_C(0x0121FB78121FB782), UINT64_C(0x0120B470C67C0D89),
+    UINT64_C(0x011F7047DC11F705), UINT64_C(0x011E2EF3B3FB8745), UINT64_C(0x011CF06ADA2811D0), UINT64_C(0x011BB4A4046ED291),
+    UINT64_C(0x011A7B9611A7B962), UINT64_C(0x0119453808CA29C1), UINT64_C(0x0118118118118119), UINT64_C(0x0116E0689427378F),
+    UINT64_C(0x0115B1E5F75270D1), UINT64_C(0x011485F0E0ACD3B7), UINT64_C(0x01135C81135C8114), UINT64_C(0x0112358E75D30337),
+    UINT64_C(0x0111111111111112), UINT64_C(0x010FEF010FEF0110), UINT64_C(0x010ECF56BE69C8FE), UINT64_C(0x010DB20A88F4695A),
+    UINT64_C(0x010C9714FBCDA3AD), UINT64_C(0x010B7E6EC259DC7A), UINT64_C(0x010A6810A6810A69), UINT64_C(0x010953F390109540),
+    UINT64_C(0x0108421084210843), UINT64_C(0x01073260A47F7C67), UINT64_C(0x010624DD2F1A9FBF), UINT64_C(0x0105197F7D734042),
+    UINT64_C(0x0104104104104105), UINT64_C(0x0103091B51F5E1A5), UINT64_C(0x0102040810204082), UINT64_C(0x0101010101010102)
+};
 
-static uint16_t S_table3[256]{
-    1579, 337, 1009, 353, 541, 163, 1607, 1367, 97, 173, 1123, 1231, 797, 397, 179, 89, 149, 619, 1223, 911, 991, 1553, 311, 1373, 683, 863, 1307, 59, 431, 607, 1429, 1543, 1303, 809, 127, 827, 1423, 1489, 1109, 617, 859, 1619, 1103, 563, 673, 1657, 457, 479, 331, 1499, 367, 223, 1493, 1229, 853, 409, 1117, 487, 1289, 157, 239, 1637, 709, 1061, 1129, 467, 1567, 733, 433, 521, 907, 997, 73, 151, 1627, 373, 419, 571, 883, 1201, 113, 449, 1601, 389, 523, 839, 31, 271, 953, 241, 23, 401, 1531, 769, 1279, 1153, 257, 131, 233, 439, 193, 41, 1597, 1213, 421, 229, 661, 1259, 61, 1409, 19, 1193, 1049, 281, 1019, 1381, 821, 613, 181, 1487, 1319, 503, 967, 499, 1447, 17, 1063, 1051, 349, 811, 727, 1321, 1249, 977, 877, 11, 277, 1181, 67, 887, 283, 13, 643, 1471, 739, 109, 1031, 587, 101, 929, 829, 47, 359, 773, 677, 599, 941, 491, 53, 1093, 1091, 1187, 569, 1021, 1217, 601, 1433, 37, 857, 1523, 1327, 641, 751, 1609, 1151, 383, 1087, 1571, 1613, 823, 1583, 71, 701, 1097, 1163, 83, 269, 761, 647, 211, 1301, 1171, 227, 653, 1483, 1439, 787, 103, 167, 757, 1039, 1283, 1453, 1277, 509, 577, 463, 263, 317, 659, 347, 1427, 557, 1399, 937, 379, 547, 631, 691, 1297, 313, 139, 1069, 1361, 1559, 79, 107, 983, 919, 593, 191, 947, 43, 199, 881, 1511, 197, 1621, 29, 307, 1481, 1033, 743, 1451, 443, 1291, 1013, 1237, 719, 137, 251, 1549, 293, 971, 461, 1459};
 static const unsigned char locha_padding[64] =
     {
         1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
@@ -48,18 +141,170 @@ static const unsigned char locha_padding[64] =
 
 typedef struct
 {
-    uint8_t state[24]{0};
+    uint32_t fstep_conv{1};
+    uint8_t sstep_conv[3]{0, 0, 7};
+} Initials;
+
+//------------------------------------------------------------
+// Each sub-block i stores the 3 nibbles of its after_3conv value in
+// hexdigit[3i..3i+2] (most significant first), copies them into
+// state, and then reverses the whole hexdigit[0..3i+2] prefix. Once
+// the block is done, the first 6 bytes of state are reversed too and
+// state is added into temp_output.
+//
+// Sub-block i only ever reads hexdigit[3i] and hexdigit[3i+1] before
+// writing them, so it sees the previous block's values there. All of
+// those reversals therefore compose into one fixed permutation of the
+// 24 nibbles written during a block, as does the state reversal. Both
+// are applied once per block below, as byte shuffles where possible.
+static const uint8_t locha_hexdigit_perm[24] = {
+    23, 22, 21, 17, 16, 15, 11, 10, 9, 5, 4, 3, 0, 1, 2, 6, 7, 8, 12, 13, 14, 18, 19, 20
+};
+static const uint8_t locha_state_perm[24] = {
+    5, 4, 3, 2, 1, 0, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23
+};
+
+#if defined(HAVE_SSSE_3)
+
+// hexdigit and temp_output as bytes [0..15] and [16..23] of 2 vectors
+typedef struct
+{
+    __m128i hexdigit[2];
+    __m128i temp_output[2];
+} LOCHA_Digits;
+
+static FORCE_INLINE void LOCHA_DigitsInit(LOCHA_Digits *digits)
+{
+    digits->hexdigit[0] = digits->hexdigit[1] = _mm_setzero_si128();
+    digits->temp_output[0] = digits->temp_output[1] = _mm_setzero_si128();
+}
+
+// prev[i] = (hexdigit[3i + 1] << 4) | hexdigit[3i]
+static FORCE_INLINE void LOCHA_PrevDigits(const LOCHA_Digits *digits, uint8_t *prev)
+{
+    const __m128i lo = _mm_shuffle_epi8(digits->hexdigit[0],
+                                        _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1));
+    const __m128i hi = _mm_shuffle_epi8(digits->hexdigit[1],
+                                        _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, -1, -1, -1, -1, -1, 0, 3, 6));
+    const __m128i t = _mm_or_si128(lo, hi);
+
+    _mm_storel_epi64((__m128i *)prev, _mm_or_si128(t, _mm_slli_epi16(_mm_srli_si128(t, 8), 4)));
+}
+
+// Split each after_3conv value into nibbles, with the low and high
+// nibbles of its low byte in nib0[2i] and nib1[2i] and the top nibble
+// in nib0[2i + 1]. The masks below are locha_hexdigit_perm and
+// locha_state_perm expressed in terms of those 2 vectors.
+static FORCE_INLINE void LOCHA_Absorb(LOCHA_Digits *digits, const uint16_t *after_3conv)
+{
+    const __m128i conv = _mm_loadu_si128((const __m128i *)after_3conv);
+    const __m128i mask = _mm_set1_epi8(15);
+    const __m128i nib0 = _mm_and_si128(conv, mask);
+    const __m128i nib1 = _mm_and_si128(_mm_srli_epi16(conv, 4), mask);
+
+    digits->hexdigit[0] = _mm_or_si128(
+        _mm_shuffle_epi8(nib0, _mm_setr_epi8(14, -1, 15, 10, -1, 11, 6, -1, 7, 2, -1, 3, 1, -1, 0, 5)),
+        _mm_shuffle_epi8(nib1, _mm_setr_epi8(-1, 14, -1, -1, 10, -1, -1, 6, -1, -1, 2, -1, -1, 0, -1, -1)));
+    digits->hexdigit[1] = _mm_or_si128(
+        _mm_shuffle_epi8(nib0, _mm_setr_epi8(-1, 4, 9, -1, 8, 13, -1, 12, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(nib1, _mm_setr_epi8(4, -1, -1, 8, -1, -1, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1)));
+
+    const __m128i state0 = _mm_or_si128(
+        _mm_shuffle_epi8(nib0, _mm_setr_epi8(2, -1, 3, 0, -1, 1, 5, -1, 4, 7, -1, 6, 9, -1, 8, 11)),
+        _mm_shuffle_epi8(nib1, _mm_setr_epi8(-1, 2, -1, -1, 0, -1, -1, 4, -1, -1, 6, -1, -1, 8, -1, -1)));
+    const __m128i state1 = _mm_or_si128(
+        _mm_shuffle_epi8(nib0, _mm_setr_epi8(-1, 10, 13, -1, 12, 15, -1, 14, -1, -1, -1, -1, -1, -1, -1, -1)),
+        _mm_shuffle_epi8(nib1, _mm_setr_epi8(10, -1, -1, 12, -1, -1, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1)));
+
+    digits->temp_output[0] = _mm_add_epi8(digits->temp_output[0], state0);
+    digits->temp_output[1] = _mm_add_epi8(digits->temp_output[1], state1);
+}
+
+// out[i] = ((temp_output[2i] & 0xF) << 4) | (temp_output[2i + 1] & 0xF)
+static FORCE_INLINE void LOCHA_Pack(const LOCHA_Digits *digits, uint8_t *out)
+{
+    const __m128i mask = _mm_set1_epi8(15);
+    const __m128i mult = _mm_set1_epi16(0x0110);
+    const __m128i lo = _mm_maddubs_epi16(_mm_and_si128(digits->temp_output[0], mask), mult);
+    const __m128i hi = _mm_maddubs_epi16(_mm_and_si128(digits->temp_output[1], mask), mult);
+    uint8_t packed[16];
+
+    _mm_storeu_si128((__m128i *)packed, _mm_packus_epi16(lo, hi));
+    memcpy(out, packed, 12);
+}
+
+#else
+
+typedef struct
+{
+    uint8_t hexdigit[24];
+    uint8_t temp_output[24];
+} LOCHA_Digits;
+
+static FORCE_INLINE void LOCHA_DigitsInit(LOCHA_Digits *digits)
+{
+    memset(digits, 0, sizeof(*digits));
+}
+
+static FORCE_INLINE void LOCHA_PrevDigits(const LOCHA_Digits *digits, uint8_t *prev)
+{
+    for (uint8_t i{0}; i < 8; i++)
+    {
+        prev[i] = (uint8_t)((digits->hexdigit[3 * i + 1] << 4) | digits->hexdigit[3 * i]);
+    }
+}
+
+static FORCE_INLINE void LOCHA_Absorb(LOCHA_Digits *digits, const uint16_t *after_3conv)
+{
+    uint8_t written[24];
+
+    for (uint8_t i{0}; i < 8; i++)
+    {
+        written[3 * i + 0] = (after_3conv[i] >> 8) & 15;
+        written[3 * i + 1] = (after_3conv[i] >> 4) & 15;
+        written[3 * i + 2] = (after_3conv[i] >> 0) & 15;
+    }
+    for (uint8_t i{0}; i < 24; i++)
+    {
+        digits->hexdigit[i] = written[locha_hexdigit_perm[i]];
+        digits->temp_output[i] += written[locha_state_perm[i]];
+    }
+}
+
+static FORCE_INLINE void LOCHA_Pack(const LOCHA_Digits *digits, uint8_t *out)
+{
+    for (uint8_t i{0}; i < 24; i += 2)
+    {
+        out[i / 2] = (((digits->temp_output[i] & 0xF) << 4) | (digits->temp_output[i + 1] & 0xF));
+    }
+}
+
+#endif
+
+// Streaming state. count[0] is the number of bytes waiting in buffer
+// (always < 64 between calls) and count[1] the number of bytes already
+// hashed as full blocks.
+typedef struct
+{
     size_t count[2]{0};
     uint8_t buffer[64]{0};
+    Initials initial;
+    LOCHA_Digits digits;
+    const LOCHA_Tables *tables;
 } LOCHA1_CTX;
-typedef struct
+
+// x % d for 1 <= d <= 255, without a hardware divide. The low 64 bits
+// of rcp * x hold the fractional part of x / d, and scaling that back up
+// by d leaves the remainder in the high word.
+static FORCE_INLINE uint32_t LOCHA_Mod(const uint32_t x, const uint8_t d)
 {
-    uint8_t hexdigit[24]{0};
-    uint32_t fstep_conv{1};
-    uint8_t sstep_conv[3]{0, 0, 7};
-} Initials;
+    uint64_t rlo, rhi;
 
-static void LOCHA_FirstStep(const uint8_t *buffer, uint8_t *pk, uint32_t &fstep_conv)
+    mult64_128(rlo, rhi, locha_rcp[d] * x, d);
+    return (uint32_t)rhi;
+}
+
+static void LOCHA_FirstStep(const uint8_t *buffer, const LOCHA_Tables *tables, uint8_t *pk, uint32_t &fstep_conv)
 {
     for (uint8_t j{0}; j < 8; j++)
     {
@@ -68,37 +313,37 @@ static void LOCHA_FirstStep(const uint8_t *buffer, uint8_t *pk, uint32_t &fstep_
             pk[j] = (buffer[j] - 31);
         else
             pk[j] = 1;
-        fstep_conv *= S_table1[pk[j]];
+        fstep_conv *= tables->S1[pk[j]];
     }
 }
 
-static void LOCHA_FirstStep_new(const uint8_t *buffer, uint8_t *pk, uint32_t &fstep_conv)
+static void LOCHA_FirstStep_new(const uint8_t *buffer, const LOCHA_Tables *tables, uint8_t *pk, uint32_t &fstep_conv)
 {
     for (uint8_t j{0}; j < 8; j++)
     {
-        // 32 non_printable ASCIIcode
-        memcpy(&pk[j], (buffer + j), 1);
-        // std::cout << (size_t)(*fstep_conv) << "*" << S_table3[pk[j]] << "=";
-        fstep_conv = static_cast<uint64_t>((fstep_conv) * S_table3[pk[j]]);
-        fstep_conv = ((fstep_conv << j * 4) | (fstep_conv >> (32 - j * 4)));
-
-        // std::cout << (size_t)(*fstep_conv) << std::endl;
+        pk[j] = buffer[j];
+        fstep_conv *= tables->S3[pk[j]];
+        fstep_conv = ROTL32(fstep_conv, j * 4);
     }
 }
 
 template <bool newver>
-static void LOCHA_Steps(LOCHA1_CTX *context, uint8_t *tempout, Initials *initial)
+static void LOCHA_Steps(const uint8_t *block, const LOCHA_Tables *tables, Initials *initial, LOCHA_Digits *digits)
 {
+    uint8_t prev[8];
+    uint16_t after_3conv[8];
+
+    LOCHA_PrevDigits(digits, prev);
     for (uint8_t i{0}; i < 8; i++)
     {
         uint8_t pk[8];
         if (newver)
-            LOCHA_FirstStep_new(&(context->buffer[8 * i]), pk, initial->fstep_conv);
+            LOCHA_FirstStep_new(&block[8 * i], tables, pk, initial->fstep_conv);
         else
-            LOCHA_FirstStep(&(context->buffer[8 * i]), pk, initial->fstep_conv);
+            LOCHA_FirstStep(&block[8 * i], tables, pk, initial->fstep_conv);
         initial->sstep_conv[0] = initial->fstep_conv % 67;
         // sub-block [1][7] ==0
-        if ((S_table3[pk[1]] & 1) == 0)
+        if ((tables->S3[pk[1]] & 1) == 0)
             initial->sstep_conv[1] = initial->sstep_conv[0];
         else
             initial->sstep_conv[1] = 67 - initial->sstep_conv[0];
@@ -107,116 +352,186 @@ static void LOCHA_Steps(LOCHA1_CTX *context, uint8_t *tempout, Initials *initial
         if (initial->sstep_conv[2] == 0)
             initial->sstep_conv[2] += 1;
         // merge after step conversions
-        uint64_t after_3conv = (((initial->fstep_conv % initial->sstep_conv[2]) + initial->fstep_conv + S_table2[initial->sstep_conv[1]]) % 255) + pk[2] + (uint8_t)((initial->hexdigit[3 * i + 1] << 4) | (initial->hexdigit[3 * i])) + (pk[0] % 127);
-        // convert after_3conversion step to hexnumber
+        after_3conv[i] = ((LOCHA_Mod(initial->fstep_conv, initial->sstep_conv[2]) + initial->fstep_conv + tables->S2[initial->sstep_conv[1]]) % 255) + pk[2] + prev[i] + (pk[0] % 127);
+    }
+    LOCHA_Absorb(digits, after_3conv);
+}
 
-        for (uint8_t k{0}; k < 3; k++)
-        {
-            initial->hexdigit[3 * i + k] = ((after_3conv >> (4 * k)) & 15);
-        }
+inline void LOCHA1_Seed(Initials *initial, const uint64_t &_seed)
+{
+    initial->fstep_conv += (_seed);
+    initial->fstep_conv ^= (_seed >> 16);
+    initial->fstep_conv += (_seed >> 32);
+    initial->fstep_conv ^= (_seed >> 48);
 
-        std::reverse(&initial->hexdigit[3 * i], &initial->hexdigit[3 * i + 3]);
-        // std::swap(initial->hexdigit[3 * i], initial->hexdigit[3 * i+2]);
-        // little endian
-        // std::cout << "hex digit is "<< std::endl;
-        // for (auto i :initial->hexdigit)
-        //     std::cout <<( size_t )i << ",";
-        // std::cout << std::endl;
-        memcpy(context->state + 3 * i, initial->hexdigit + 3 * i, 3);
-        std::reverse(initial->hexdigit, initial->hexdigit + 3 * (i + 1));
-    }
-    std::reverse(context->state, context->state + 6);
-    std::transform(context->state, context->state + 24, tempout, tempout, std::plus<uint8_t>());
-    std::fill_n(context->state, 24, 0);
-    context->count[0] -= 64;
-    context->count[1] += 64;
+    if (initial->fstep_conv == 0)
+        initial->fstep_conv += 2;
+}
+static void LOCHA1_Init(LOCHA1_CTX *context, const uint64_t seed, const LOCHA_Tables *tables = &locha_tables)
+{
+    context->tables = tables;
+    context->count[0] = 0;
+    context->count[1] = 0;
+    context->initial = Initials();
+    LOCHA1_Seed(&context->initial, seed);
+    LOCHA_DigitsInit(&context->digits);
 }
 
 template <bool newver>
-static void LOCHA1_Update(LOCHA1_CTX *context, const uint8_t *data, const size_t &len, void *out, Initials &initial)
+static void LOCHA1_Update(LOCHA1_CTX *context, const uint8_t *data, size_t len)
 {
-    context->count[0] = len;
-    if (context->count[0] == 0)
-        return;
-    uint8_t temp_output[24]{0};
-    while (context->count[0] >= 64)
+    if (context->count[0] != 0)
     {
+        const size_t fill = std::min(len, (size_t)64 - context->count[0]);
+        memcpy(context->buffer + context->count[0], data, fill);
+        context->count[0] += fill;
+        data += fill;
+        len -= fill;
+        if (context->count[0] < 64)
+            return;
+        LOCHA_Steps<newver>(context->buffer, context->tables, &context->initial, &context->digits);
+        context->count[0] = 0;
+        context->count[1] += 64;
+    }
+    // Full blocks are hashed straight from the caller's buffer. A final
+    // full block is too, since padding always adds a block of its own.
+    while (len >= 64)
+    {
+        LOCHA_Steps<newver>(data, context->tables, &context->initial, &context->digits);
+        data += 64;
+        len -= 64;
+        context->count[1] += 64;
+    }
+    memcpy(context->buffer, data, len);
+    context->count[0] = len;
+}
 
-        memcpy(&(context->buffer[0]), (data + context->count[1]), 64);
-        LOCHA_Steps<newver>(context, temp_output, &initial);
+template <bool newver>
+static void LOCHA1_Final(LOCHA1_CTX *context, uint8_t *out)
+{
+    // The empty message hashes to all zeroes; it gets no padding block.
+    if ((context->count[0] == 0) && (context->count[1] == 0))
+    {
+        memset(out, 0, 12);
+        return;
     }
+    memcpy(context->buffer + context->count[0], locha_padding, 64 - context->count[0]);
+    LOCHA_Steps<newver>(context->buffer, context->tables, &context->initial, &context->digits);
+    context->count[1] += context->count[0];
+    context->count[0] = 0;
+    // remove 4end-pointless zeros from hexdigits,(4 bit not 8!)
+    LOCHA_Pack(&context->digits, out);
+}
 
-    memcpy(&context->buffer[0], (data + context->count[1]), context->count[0]);
-    memcpy(context->buffer + context->count[0], locha_padding,
-           (64 - context->count[0]));
-    context->count[0] += (64 - context->count[0]);
-    LOCHA_Steps<newver>(context, temp_output, &initial);
-    // std::cout << "tempout " << std::endl;
+//------------------------------------------------------------
+template <bool newver>
+static void LOCHA1(const void *in, const size_t len, const size_t seed, void *out)
+{
+    LOCHA1_CTX locha_ctx;
 
-    // for (size_t i{0}; i < 24; i++)
-    // {
-    //     std::cout << (size_t)temp_output[i] << ",";
-    // }
-    // std::cout << "tempout is end " << std::endl;
+    LOCHA1_Init(&locha_ctx, seed);
+    LOCHA1_Update<newver>(&locha_ctx, (const uint8_t *)in, len);
+    LOCHA1_Final<newver>(&locha_ctx, (uint8_t *)out);
+}
 
-    // probably num of input bits is divisible by 64
-    try
-    {
-        if (context->count[0])
-            throw(context->count[0]);
-        else
-            // remove 4end-pointless zeros from hexdigits,(4 bit not 8!)
-            for (uint8_t i{0}; i < 24; i += 2)
-            {
-                *((uint8_t *)(out) + i / 2) += (((temp_output[i] & 0xF) << 4) | (temp_output[i + 1] & 0xF));
-            }
-    }
-    catch (const size_t &reminded_bits)
+//------------------------------------------------------------
+// Seeded LOCHA: besides fstep_conv, the seed also shuffles all three
+// S-boxes. The shuffled copies are built once per seed by the seedfn,
+// into a per-thread table block whose address becomes the seed the
+// hash function sees.
+typedef struct
+{
+    LOCHA_Tables tables;
+    uint64_t seed;
+} LOCHA_SeedTables;
+
+alignas(64) static thread_local LOCHA_SeedTables locha_seeded;
+
+static uint64_t locha_splitmix(uint64_t &state)
+{
+    uint64_t z = (state += UINT64_C(0x9e3779b97f4a7c15));
+
+    z = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+    return z ^ (z >> 31);
+}
+
+// Fisher-Yates shuffle of table[0..n-1]
+static void LOCHA_Shuffle(uint16_t *table, const uint32_t n, uint64_t &state)
+{
+    for (uint32_t i = n - 1; i > 0; i--)
     {
-        std::cout << "padding is done wrong ! " << reminded_bits << "bits remidned" << std::endl;
+        const uint32_t j = (uint32_t)(locha_splitmix(state) % (i + 1));
+        std::swap(table[i], table[j]);
     }
 }
-inline void LOCHA1_Seed(Initials *initial, const uint64_t &_seed)
+
+static uintptr_t LOCHA1_seeded_seed(const seed_t seed)
 {
+    uint64_t state = (uint64_t)seed;
 
-    // std::shuffle(S_table3,S_table3+24,std::default_random_engine(_seed));
-    initial->fstep_conv += (_seed);
-    // std::cout<<initial->fstep_conv<<",";
-    initial->fstep_conv ^= (_seed >> 16);
-    // std::cout << initial->fstep_conv << ",";
-    initial->fstep_conv += (_seed >> 32);
-    // std::cout << initial->fstep_conv << ",";
-    initial->fstep_conv ^= (_seed >> 48);
+    locha_seeded.tables = locha_tables;
+    locha_seeded.seed = (uint64_t)seed;
+    LOCHA_Shuffle(locha_seeded.tables.S1, 97, state);
+    // S2[67] is the fixed 0 entry for sstep_conv[1] == 67; leave it be.
+    LOCHA_Shuffle(locha_seeded.tables.S2, 67, state);
+    LOCHA_Shuffle(locha_seeded.tables.S3, 256, state);
+    return (seed_t)(uintptr_t)&locha_seeded;
+}
 
-    if (initial->fstep_conv == 0)
-        initial->fstep_conv += 2;
+template <bool newver>
+static void LOCHA1_seeded(const void *in, const size_t len, const seed_t seed, void *out)
+{
+    const LOCHA_SeedTables *seeded = (const LOCHA_SeedTables *)(uintptr_t)seed;
+    LOCHA1_CTX locha_ctx;
 
-    // std::cout << "|fstep after : " << (size_t)initial->fstep_conv << std::endl;
+    LOCHA1_Init(&locha_ctx, seeded->seed, &seeded->tables);
+    LOCHA1_Update<newver>(&locha_ctx, (const uint8_t *)in, len);
+    LOCHA1_Final<newver>(&locha_ctx, (uint8_t *)out);
 }
+
 //------------------------------------------------------------
+// Check that feeding a message one byte at a time, for every length up
+// to a little over 3 blocks, or the longest of those messages in two
+// chunks split at every possible point, gives the same result as
+// hashing it in one go. This runs from initfn, so it is kept to a few
+// hundred hashes.
 template <bool newver>
-static void LOCHA1(const void *in, const size_t len, const size_t seed, void *out)
+static bool LOCHA1_StreamSelftest(void)
 {
-    LOCHA1_CTX locha_ctx;
-    uint8_t *hash[12]{0};
-    Initials initial_var;
-    LOCHA1_Seed(&initial_var, seed);
-    // std::cout <<"hex is : "<<(size_t)initial_var.hexdigit[1]<<std::endl;
-    LOCHA1_Update<newver>(&locha_ctx, (const uint8_t *)in, len, hash, initial_var);
-    memcpy((uint8_t *)out, hash, 12);
-    // std::cout << "input is "
-    //           << ":";
-    // for (size_t i{0}; i < len; i += 1)
-    // {
-    //     std::cout << (size_t)input[i] << ",";
-    // }
-    // std::cout << "output is "
-    //           << ":";
-    // for (uint8_t i{0}; i < 12; i += 1)
-    // {
-    //     std::cout << (size_t)hash[i] << ",";
-    // }
-    // std::cout << std::endl;
+    uint8_t data[3 * 64 + 5];
+    uint8_t expected[12], actual[12];
+    LOCHA1_CTX ctx;
+    bool passed = true;
+
+    for (size_t j = 0; j < sizeof(data); j++)
+        data[j] = (uint8_t)(j * 73 + 41);
+    for (size_t len = 0; len <= sizeof(data); len++)
+    {
+        LOCHA1<newver>(data, len, len, expected);
+        for (size_t split = 0; (len == sizeof(data)) && (split <= len); split++)
+        {
+            LOCHA1_Init(&ctx, len);
+            LOCHA1_Update<newver>(&ctx, data, split);
+            LOCHA1_Update<newver>(&ctx, data + split, len - split);
+            LOCHA1_Final<newver>(&ctx, actual);
+            if (memcmp(expected, actual, 12) != 0)
+            {
+                printf("LOCHA streaming mismatch for len %zu split at %zu\n", len, split);
+                passed = false;
+            }
+        }
+        LOCHA1_Init(&ctx, len);
+        for (size_t j = 0; j < len; j++)
+            LOCHA1_Update<newver>(&ctx, data + j, 1);
+        LOCHA1_Final<newver>(&ctx, actual);
+        if (memcmp(expected, actual, 12) != 0)
+        {
+            printf("LOCHA bytewise streaming mismatch for len %zu\n", len);
+            passed = false;
+        }
+    }
+    return passed;
 }
 
 //------------------------------------------------------------
@@ -226,30 +541,78 @@ REGISTER_FAMILY(locha,
 
 REGISTER_HASH(LOCHA_1,
               $.desc = "Light-weight One-way Cryptographic Hash Algorithm for Wireless Sensor Network",
+              $.impl = LOCHA_IMPL_STR,
               $.hash_flags =
-                  FLAG_IMPL_CANONICAL_LE |
-                  FLAG_IMPL_ROTATE |
-                  FLAG_IMPL_INCREMENTAL |
-                  FLAG_IMPL_VERY_SLOW,
-              $.impl_flags =
                   FLAG_HASH_CRYPTOGRAPHIC_WEAK |
                   FLAG_HASH_ENDIAN_INDEPENDENT |
                   FLAG_HASH_NO_SEED,
+              $.impl_flags =
+                  FLAG_IMPL_CANONICAL_LE |
+                  FLAG_IMPL_INCREMENTAL |
+                  FLAG_IMPL_MODULUS |
+                  FLAG_IMPL_VERY_SLOW,
               $.bits = 96,
+              $.initfn = LOCHA1_StreamSelftest<false>,
+              $.verification_LE = 0x208564C7,
+              $.verification_BE = 0x208564C7,
               $.hashfn_native = LOCHA1<false>,
               $.hashfn_bswap = LOCHA1<false>);
 
 REGISTER_HASH(LOCHA_2,
               $.desc = "Light-weight One-way Cryptographic Hash Algorithm for Wireless Sensor Network-vesion2",
+              $.impl = LOCHA_IMPL_STR,
               $.hash_flags =
+                  FLAG_HASH_CRYPTOGRAPHIC_WEAK |
+                  FLAG_HASH_ENDIAN_INDEPENDENT |
+                  FLAG_HASH_NO_SEED,
+              $.impl_flags =
                   FLAG_IMPL_CANONICAL_LE |
                   FLAG_IMPL_ROTATE |
                   FLAG_IMPL_INCREMENTAL |
+                  FLAG_IMPL_MODULUS |
                   FLAG_IMPL_VERY_SLOW,
+              $.bits = 96,
+              $.initfn = LOCHA1_StreamSelftest<true>,
+              $.verification_LE = 0x96B85EB9,
+              $.verification_BE = 0x96B85EB9,
+              $.hashfn_native = LOCHA1<true>,
+              $.hashfn_bswap = LOCHA1<true>);
+
+REGISTER_HASH(LOCHA_1__seeded,
+              $.desc = "Light-weight One-way Cryptographic Hash Algorithm for Wireless Sensor Network, seed-shuffled S-boxes",
+              $.impl = LOCHA_IMPL_STR,
+              $.hash_flags =
+                  FLAG_HASH_CRYPTOGRAPHIC_WEAK |
+                  FLAG_HASH_LOOKUP_TABLE |
+                  FLAG_HASH_ENDIAN_INDEPENDENT,
               $.impl_flags =
+                  FLAG_IMPL_CANONICAL_LE |
+                  FLAG_IMPL_INCREMENTAL |
+                  FLAG_IMPL_MODULUS |
+                  FLAG_IMPL_VERY_SLOW,
+              $.bits = 96,
+              $.verification_LE = 0x61166377,
+              $.verification_BE = 0x61166377,
+              $.seedfn = LOCHA1_seeded_seed,
+              $.hashfn_native = LOCHA1_seeded<false>,
+              $.hashfn_bswap = LOCHA1_seeded<false>);
+
+REGISTER_HASH(LOCHA_2__seeded,
+              $.desc = "Light-weight One-way Cryptographic Hash Algorithm for Wireless Sensor Network-vesion2, seed-shuffled S-boxes",
+              $.impl = LOCHA_IMPL_STR,
+              $.hash_flags =
                   FLAG_HASH_CRYPTOGRAPHIC_WEAK |
-                  FLAG_HASH_ENDIAN_INDEPENDENT |
-                  FLAG_HASH_NO_SEED,
+                  FLAG_HASH_LOOKUP_TABLE |
+                  FLAG_HASH_ENDIAN_INDEPENDENT,
+              $.impl_flags =
+                  FLAG_IMPL_CANONICAL_LE |
+                  FLAG_IMPL_ROTATE |
+                  FLAG_IMPL_INCREMENTAL |
+                  FLAG_IMPL_MODULUS |
+                  FLAG_IMPL_VERY_SLOW,
               $.bits = 96,
-              $.hashfn_native = LOCHA1<true>,
-              $.hashfn_bswap = LOCHA1<true>);
\ No newline at end of file
+              $.verification_LE = 0xE6944FA6,
+              $.verification_BE = 0xE6944FA6,
+              $.seedfn = LOCHA1_seeded_seed,
+              $.hashfn_native = LOCHA1_seeded<true>,
+              $.hashfn_bswap = LOCHA1_seeded<true>);
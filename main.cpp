@@ -68,6 +68,8 @@
 #include "Analyze.h"
 #include "Stats.h"
 #include "VCode.h"
+#include "PerfCounters.h"
+#include "SysInfo.h"
 #include "version.h"
 
 #include "SanityTest.h"
@@ -79,6 +81,9 @@
 #include "TextKeysetTest.h"
 #include "PermutationKeysetTest.h"
 #include "SpeedTest.h"
+#include "SpeedScalingTest.h"
+#include "SeedSpeedTest.h"
+#include "SpeedBaseline.h"
 #include "PerlinNoiseTest.h"
 #include "PopcountTest.h"
 #include "PRNGTest.h"
@@ -101,6 +106,10 @@
 #include <inttypes.h>
 #include <time.h>
 #include <errno.h>
+#include <limits.h>
+
+#include <string>
+#include <vector>
 
 //-----------------------------------------------------------------------------
 // Globally-visible configuration
@@ -123,6 +132,7 @@ static bool g_drawDiagram = false;
 
 // excessive torture tests: Sparse, Avalanche, DiffDist, scan all seeds
 static bool g_testExtra = false;
+static bool g_perfCounters = false;
 
 static bool g_testAll;
 static bool g_testVerifyAll;
@@ -130,7 +140,16 @@ static bool g_testSanityAll;
 static bool g_testSpeedAll;
 static bool g_testSanity;
 static bool g_testSpeed;
+static bool g_testSpeedSweep;
+static bool g_testSpeedScaling;
+static bool g_testSpeedCompare;
+static bool g_testSpeedWorkload;
+static bool g_testSpeedCold;
+static bool g_testSeedSpeed;
 static bool g_testHashmap;
+static bool g_testHashmapWorkload;
+static bool g_testHashmapThreads;
+static bool g_testHashmapLarge;
 static bool g_testAvalanche;
 static bool g_testSparse;
 static bool g_testPermutation;
@@ -154,6 +173,34 @@ static bool g_testPrng;
 static bool g_testBIC;
 static bool g_testBadSeeds;
 
+// Options for the SpeedSweep test
+static uint64_t         g_sweepMaxLen = UINT64_C(64) << 20;
+static SpeedSweepFormat g_sweepFormat = SWEEP_TEXT;
+
+// Options for the SpeedCompare test
+static const char * g_compareWith = NULL; // A hash name, or a samples file
+static const char * g_compareSave = NULL;
+static bool         g_compareAnyHash = false;
+
+// CPU to pin speed tests to, or -1 to not pin them
+static int g_pinCPU = -1;
+static std::vector<unsigned> g_allowedCPUs;
+
+// Options for the SpeedWorkload test
+static const char * g_workload = NULL; // A profile name or histogram file; NULL for all profiles
+
+// Options for the HashmapWorkload test
+static const char * g_hashmapWorkload = NULL; // A workload name or spec; NULL for all workloads
+
+// Options for the HashmapLarge test
+static uint32_t     g_hashmapKeys   = 0;    // Keys to insert; 0 for a default based on hash speed
+static const char * g_hashmapKeyset = NULL; // A key family name; NULL for all families
+
+// Results from the Speed, SpeedAll, and SpeedWorkload tests can be
+// saved to, and checked against, a baseline file
+static const char * g_baselineSave  = NULL;
+static const char * g_baselineCheck = NULL;
+
 struct TestOpts {
     bool &       var;
     bool         defaultvalue;  // What "All" sets the test to
@@ -168,7 +215,16 @@ static TestOpts g_testopts[] = {
     { g_testAll,              true,     false,    "All" },
     { g_testSanity,           true,     false,    "Sanity" },
     { g_testSpeed,            true,      true,    "Speed" },
+    { g_testSpeedSweep,      false,      true,    "SpeedSweep" },
+    { g_testSpeedScaling,    false,      true,    "SpeedScaling" },
+    { g_testSpeedCompare,    false,      true,    "SpeedCompare" },
+    { g_testSpeedWorkload,   false,      true,    "SpeedWorkload" },
+    { g_testSpeedCold,       false,      true,    "SpeedCold" },
+    { g_testSeedSpeed,       false,      true,    "SeedSpeed" },
     { g_testHashmap,          true,      true,    "Hashmap" },
+    { g_testHashmapWorkload, false,      true,    "HashmapWorkload" },
+    { g_testHashmapThreads,  false,      true,    "HashmapThreads" },
+    { g_testHashmapLarge,    false,      true,    "HashmapLarge" },
     { g_testAvalanche,        true,     false,    "Avalanche" },
     { g_testSparse,           true,     false,    "Sparse" },
     { g_testPermutation,      true,     false,    "Permutation" },
@@ -336,6 +392,45 @@ static void HashSanityTestAll( bool verbose ) {
     printf("\n");
 }
 
+//-----------------------------------------------------------------------------
+// Speed tests can be pinned to a single CPU, so that migrations don't
+// disturb their timings. Other tests may still use every CPU the
+// process is allowed, since threads inherit the creator's affinity.
+
+static void PinSpeedTests( bool pin ) {
+    if (g_pinCPU < 0) {
+        return;
+    }
+    if (pin) {
+        PinThreadToCPU(g_pinCPU);
+    } else {
+        SetThreadCPUs(g_allowedCPUs);
+    }
+}
+
+// Pinning is tried once up front, so any problems are reported before
+// testing starts.
+static void CheckPinCPU( void ) {
+    g_allowedCPUs = GetAllowedCPUs();
+    if (!PinThreadToCPU(g_pinCPU)) {
+        printf("Could not pin to CPU %d\n", g_pinCPU);
+        exit(1);
+    }
+    SetThreadCPUs(g_allowedCPUs);
+
+    printf("Speed tests will be pinned to CPU %d\n", g_pinCPU);
+    if (IsCPUIsolated(g_pinCPU) == 0) {
+        printf("WARNING: CPU %d is not isolated (see the isolcpus= kernel option); "
+                "other tasks may run on it\n", g_pinCPU);
+    }
+    const std::string governor = GetCPUGovernor(g_pinCPU);
+    if (!governor.empty() && (governor != "performance")) {
+        printf("WARNING: CPU %d frequency governor is \"%s\", not \"performance\"\n",
+                g_pinCPU, governor.c_str());
+    }
+    printf("\n");
+}
+
 //-----------------------------------------------------------------------------
 // Quickly speed test all hashes
 
@@ -346,6 +441,7 @@ static void HashSpeedTestAll( bool verbose ) {
 
     printf("[[[ Short Speed Tests ]]]\n\n");
 
+    PinSpeedTests(true);
     ShortSpeedTestHeader(verbose);
     for (const HashInfo * h: allHashes) {
         if ((h->hash_flags & mask_flags) != prev_flags) {
@@ -358,6 +454,7 @@ static void HashSpeedTestAll( bool verbose ) {
         }
         ShortSpeedTest(h, verbose);
     }
+    PinSpeedTests(false);
     printf("\n");
 }
 
@@ -394,7 +491,11 @@ static bool test( const HashInfo * hInfo ) {
         printf("-------------------------------------------------------------------------------\n");
     }
 
-    if (!hInfo->Init()) {
+    // The first Init() call is timed for the SeedSpeed test
+    uint64_t initBegin = timer_start();
+    bool     initOk    = hInfo->Init();
+    uint64_t initEnd   = timer_end();
+    if (!initOk) {
         printf("Hash initialization failed! Cannot continue.\n");
         exit(1);
     }
@@ -411,7 +512,10 @@ static bool test( const HashInfo * hInfo ) {
     // Sanity tests
 
     FILE * outfile;
-    if (g_testAll || g_testSpeed || g_testHashmap) {
+    if (g_testAll || g_testSpeed || g_testSpeedScaling || g_testSpeedCompare ||
+            g_testSpeedWorkload || g_testSpeedCold || g_testSeedSpeed || g_testHashmap ||
+            g_testHashmapWorkload || g_testHashmapThreads || g_testHashmapLarge ||
+            (g_testSpeedSweep && (g_sweepFormat == SWEEP_TEXT))) {
         outfile = stdout;
     } else {
         outfile = stderr;
@@ -439,12 +543,58 @@ static bool test( const HashInfo * hInfo ) {
     //-----------------------------------------------------------------------------
     // Speed tests
 
+    PinSpeedTests(true);
+
     if (g_testSpeed) {
         SpeedTest(hInfo);
     }
 
+    if (g_testSpeedSweep) {
+        SpeedSweepTest(hInfo, g_sweepMaxLen, g_sweepFormat);
+    }
+
+    if (g_testSpeedWorkload) {
+        SpeedWorkloadTest(hInfo, g_workload);
+    }
+
+    if (g_testSpeedCold) {
+        SpeedColdTest(hInfo);
+    }
+
+    if (g_testSeedSpeed) {
+        SeedSpeedTest(hInfo, initEnd - initBegin);
+    }
+
+    if (g_testSpeedCompare) {
+        const HashInfo * other = (g_compareWith != NULL) ? findHash(g_compareWith) : NULL;
+        if ((other != NULL) && !other->Init()) {
+            printf("Hash initialization failed for %s! Cannot compare.\n", other->name);
+            exit(1);
+        }
+        SpeedCompareTest(hInfo, other, (other == NULL) ? g_compareWith : NULL, g_compareSave, g_compareAnyHash);
+    }
+
     if (g_testHashmap) {
-        result &= HashMapTest(hInfo, g_drawDiagram, g_testExtra);
+        result &= HashMapTest<hashtype>(hInfo, g_drawDiagram, g_testExtra);
+    }
+
+    if (g_testHashmapWorkload) {
+        HashMapWorkloadTest<hashtype>(hInfo, g_hashmapWorkload);
+    }
+
+    if (g_testHashmapLarge) {
+        HashMapLargeTest<hashtype>(hInfo, g_hashmapKeys, g_hashmapKeyset);
+    }
+
+    PinSpeedTests(false);
+
+    // These pin their own threads, and must see every allowed CPU
+    if (g_testSpeedScaling) {
+        SpeedScalingTest(hInfo);
+    }
+
+    if (g_testHashmapThreads) {
+        HashMapThreadsTest<hashtype>(hInfo);
     }
 
     //-----------------------------------------------------------------------------
@@ -689,7 +839,15 @@ static bool testHash( const char * name ) {
 static void usage( void ) {
     printf("Usage: SMHasher3 [--[no]test=<testname>[,...]] [--extra] [--seed=<globalseed>]\n"
            "                 [--endian=default|nondefault|native|nonnative|big|little]\n"
-           "                 [--verbose] [--vcode] [--ncpu=N] [<hashname>]\n"
+           "                 [--verbose] [--vcode] [--perf] [--hugepages] [--ncpu=N] [--pin-cpu=N]\n"
+           "                 [--sort-budget=<bytes>[K|M|G]]\n"
+           "                 [--sweep-max=<bytes>[K|M|G]] [--sweep-format=text|csv|json]\n"
+           "                 [--compare=<hashname>|<file>] [--compare-save=<file>] [--compare-any-hash]\n"
+           "                 [--workload=intid|uuid|url|logline|kv|<file>]\n"
+           "                 [--hashmap-workload=ycsb-a|ycsb-b|ycsb-c|cache|churn|<spec>]\n"
+           "                 [--hashmap-keys=<count>[K|M]] [--hashmap-keyset=id64|uuid|url|composite]\n"
+           "                 [--speed-baseline-save=<file>] [--speed-baseline-check=<file>]\n"
+           "                 [<hashname>]\n"
            "\n"
            "       SMHasher3 [--list]|[--listnames]|[--tests]|[--version]\n"
            "\n"
@@ -758,6 +916,10 @@ int main( int argc, const char ** argv ) {
                 g_testExtra = true;
                 continue;
             }
+            if (strcmp(arg, "--perf") == 0) {
+                g_perfCounters = true;
+                continue;
+            }
             // VCodes allow easy comparison of test results and hash inputs
             // and outputs across SMHasher3 runs, hashes (of the same width),
             // and systems.
@@ -766,6 +928,12 @@ int main( int argc, const char ** argv ) {
                 VCODE_INIT();
                 continue;
             }
+            // Huge pages must be enabled before any memory is
+            // allocated through HugePageAlloc().
+            if (strcmp(arg, "--hugepages") == 0) {
+                HugePagesEnable();
+                continue;
+            }
             if (strncmp(arg, "--endian=", 9) == 0) {
                 g_hashEndian = parse_endian(&arg[9]);
                 continue;
@@ -801,6 +969,113 @@ int main( int argc, const char ** argv ) {
                 continue;
 #endif
             }
+            if (strncmp(arg, "--pin-cpu=", 10) == 0) {
+                errno = 0;
+                char *   endptr;
+                long int cpu = strtol(&arg[10], &endptr, 0);
+                if ((errno != 0) || (arg[10] == '\0') || (*endptr != '\0') || (cpu < 0) || (cpu > INT_MAX)) {
+                    printf("Error parsing cpu number \"%s\"\n", &arg[10]);
+                    exit(1);
+                }
+                g_pinCPU = cpu;
+                continue;
+            }
+            if (strncmp(arg, "--sweep-max=", 12) == 0) {
+                errno = 0;
+                char *   endptr;
+                uint64_t maxlen = strtoull(&arg[12], &endptr, 0);
+                switch (*endptr) {
+                case 'K': case 'k': maxlen <<= 10; endptr++; break;
+                case 'M': case 'm': maxlen <<= 20; endptr++; break;
+                case 'G': case 'g': maxlen <<= 30; endptr++; break;
+                default:                                     break;
+                }
+                if ((errno != 0) || (arg[12] == '\0') || (*endptr != '\0') || (maxlen < 32)) {
+                    printf("Error parsing sweep length \"%s\"\n", &arg[12]);
+                    exit(1);
+                }
+                g_sweepMaxLen = maxlen;
+                continue;
+            }
+            if (strncmp(arg, "--sweep-format=", 15) == 0) {
+                if (strcmp(&arg[15], "text") == 0) {
+                    g_sweepFormat = SWEEP_TEXT;
+                } else if (strcmp(&arg[15], "csv") == 0) {
+                    g_sweepFormat = SWEEP_CSV;
+                } else if (strcmp(&arg[15], "json") == 0) {
+                    g_sweepFormat = SWEEP_JSON;
+                } else {
+                    printf("Unknown sweep format: %s\n", &arg[15]);
+                    usage();
+                    exit(1);
+                }
+                continue;
+            }
+            if (strncmp(arg, "--compare=", 10) == 0) {
+                g_compareWith = &arg[10];
+                continue;
+            }
+            if (strncmp(arg, "--compare-save=", 15) == 0) {
+                g_compareSave = &arg[15];
+                continue;
+            }
+            if (strcmp(arg, "--compare-any-hash") == 0) {
+                g_compareAnyHash = true;
+                continue;
+            }
+            if (strncmp(arg, "--workload=", 11) == 0) {
+                g_workload = &arg[11];
+                continue;
+            }
+            if (strncmp(arg, "--hashmap-workload=", 19) == 0) {
+                g_hashmapWorkload = &arg[19];
+                continue;
+            }
+            if (strncmp(arg, "--sort-budget=", 14) == 0) {
+                errno = 0;
+                char *   endptr;
+                uint64_t budget = strtoull(&arg[14], &endptr, 0);
+                switch (*endptr) {
+                case 'K': case 'k': budget <<= 10; endptr++; break;
+                case 'M': case 'm': budget <<= 20; endptr++; break;
+                case 'G': case 'g': budget <<= 30; endptr++; break;
+                default:                                     break;
+                }
+                if ((errno != 0) || (arg[14] == '\0') || (*endptr != '\0')) {
+                    printf("Error parsing sort budget \"%s\"\n", &arg[14]);
+                    exit(1);
+                }
+                g_blobsortScratchMax = budget;
+                continue;
+            }
+            if (strncmp(arg, "--hashmap-keys=", 15) == 0) {
+                errno = 0;
+                char *   endptr;
+                uint64_t keys = strtoull(&arg[15], &endptr, 0);
+                switch (*endptr) {
+                case 'K': case 'k': keys *= 1000;    endptr++; break;
+                case 'M': case 'm': keys *= 1000000; endptr++; break;
+                default:                                       break;
+                }
+                if ((errno != 0) || (arg[15] == '\0') || (*endptr != '\0') || (keys < 1) || (keys > (1u << 30))) {
+                    printf("Error parsing hashmap key count \"%s\"\n", &arg[15]);
+                    exit(1);
+                }
+                g_hashmapKeys = keys;
+                continue;
+            }
+            if (strncmp(arg, "--hashmap-keyset=", 17) == 0) {
+                g_hashmapKeyset = &arg[17];
+                continue;
+            }
+            if (strncmp(arg, "--speed-baseline-save=", 22) == 0) {
+                g_baselineSave = &arg[22];
+                continue;
+            }
+            if (strncmp(arg, "--speed-baseline-check=", 23) == 0) {
+                g_baselineCheck = &arg[23];
+                continue;
+            }
             if (strncmp(arg, "--test=", 6) == 0) {
                 // If a list of tests is given, only test those
                 g_testAll = false;
@@ -829,6 +1104,14 @@ int main( int argc, const char ** argv ) {
         hashToTest = arg;
     }
 
+    if (g_pinCPU >= 0) {
+        CheckPinCPU();
+    }
+
+    if (g_perfCounters) {
+        PerfCountersEnable();
+    }
+
     size_t timeBegin = monotonic_clock();
 
     if (g_testVerifyAll) {
@@ -843,6 +1126,18 @@ int main( int argc, const char ** argv ) {
 
     size_t timeEnd = monotonic_clock();
 
+    HugePagesReport();
+
+    // Check before saving, so a baseline file can be checked and then
+    // updated in a single run.
+    int status = 0;
+    if ((g_baselineCheck != NULL) && (SpeedBaselineCheck(g_baselineCheck, g_drawDiagram) != 0)) {
+        status = 1;
+    }
+    if ((g_baselineSave != NULL) && !SpeedBaselineSave(g_baselineSave, VERSION)) {
+        status = 1;
+    }
+
     uint32_t vcode = VCODE_FINALIZE();
 
     FILE * outfile = g_testAll ? stdout : stderr;
@@ -855,5 +1150,5 @@ int main( int argc, const char ** argv ) {
     fprintf(outfile, "Verification value is 0x%08x - Testing took %f seconds\n\n",
             vcode, (double)(timeEnd - timeBegin) / (double)NSEC_PER_SEC);
 
-    return 0;
+    return status;
 }
@@ -85,7 +85,7 @@ static void TestSeedRangeThread( const HashInfo * hinfo, const uint64_t hi, cons
     const HashFn             hash  = hinfo->hashFn(g_hashEndian);
     const seed_t             last  = hi | endlow;
     const hashtype           zero  = { 0 };
-    std::vector<hashtype>    hashes( numtestbytes * numtestlens );
+    hugevector<hashtype>     hashes( numtestbytes * numtestlens );
     std::set<hashtype>       collisions;
 
     const char * progress_fmt =
@@ -304,7 +304,7 @@ template <typename hashtype>
 static bool TestSingleSeed( const HashInfo * hinfo, const seed_t seed ) {
     const HashFn hash = hinfo->hashFn(g_hashEndian);
     const hashtype        zero = { 0 };
-    std::vector<hashtype> hashes( numtestbytes * numtestlens );
+    hugevector<hashtype> hashes( numtestbytes * numtestlens );
     std::set<hashtype>    collisions;
     bool result = true;
 
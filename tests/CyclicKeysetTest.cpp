@@ -71,7 +71,7 @@ static bool CyclicKeyImpl( HashFn hash, const seed_t seed, int cycleReps, const
 
     Rand r( 483723 + 4883 * cycleReps + cycleLen );
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     hashes.resize(keycount);
 
     int keyLen      = cycleLen * cycleReps;
@@ -71,12 +71,12 @@ static bool DiffDistTest2( const HashInfo * hinfo, const seed_t seed, bool drawD
     const int keycount = 512 * 1024 * (ckuniq ? 2 : (hinfo->bits <= 64) ? 3 : 4);
     keytype   k;
 
-    std::vector<hashtype> worsthashes;
+    hugevector<hashtype> worsthashes;
     int worstlogp   = -1;
     int worstkeybit = -1;
     int fails       =  0;
 
-    std::vector<hashtype> hashes( keycount );
+    hugevector<hashtype> hashes( keycount );
     hashtype h1, h2;
 
     std::unordered_set<uint64_t> seen; // need to be unique, otherwise we report collisions
@@ -212,7 +212,7 @@ INSTANTIATE(DiffDistTest, HASHTYPELIST);
 template <typename keytype, typename hashtype>
 void DiffDistTest( HashFn hash, const int diffbits, int trials, double & worst, double & avg ) {
     std::vector<keytype>  keys( trials );
-    std::vector<hashtype> A( trials ), B(trials);
+    hugevector<hashtype> A( trials ), B(trials);
 
     // FIXME seedHash(hash, g_seed);
     for (int i = 0; i < trials; i++) {
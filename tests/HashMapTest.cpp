@@ -49,15 +49,33 @@
 #include "Stats.h" // For FilterOutliers, CalcMean, CalcStdv
 #include "Random.h"
 #include "Wordlist.h"
+#include "PerfCounters.h"
+#include "SysInfo.h"
+#include "Instantiate.h"
 
 #include "HashMapTest.h"
 
 #include <string>
+#include <vector>
 #include <unordered_map>
+#include <cmath>
 #undef prefetch
 #include <parallel_hashmap/phmap.h>
 #include <functional>
 
+#if defined(HAVE_THREADS)
+  #include <atomic>
+  #include <thread>
+  #include <mutex>
+typedef std::atomic<unsigned> a_uint;
+typedef std::atomic<bool>     a_bool;
+typedef std::mutex            hashmap_mutex;
+#else
+typedef unsigned         a_uint;
+typedef bool             a_bool;
+typedef phmap::NullMutex hashmap_mutex;
+#endif
+
 
 //-----------------------------------------------------------------------------
 // This is functionally a speed test, and so will not inform VCodes,
@@ -66,129 +84,295 @@
 //-----------------------------------------------------------------------------
 using namespace std;
 
+// A pointer and length, so that lookups don't need a std::string to be
+// constructed. This is a stand-in for std::string_view, which needs
+// C++17.
+struct KeyView {
+    const char *  ptr;
+    size_t        len;
+
+    KeyView( const char * p, size_t l ) : ptr( p ), len( l ) {}
+
+    KeyView( const std::string & s ) : ptr( s.data() ), len( s.size() ) {}
+};
+
+// The hasher is templated on the hash's output type, so the output can
+// go into a correctly-sized buffer on the stack, and each table's
+// hashing is a direct call instead of going through std::function.
+//
+// Both the hasher and the key comparison are transparent, so the
+// phmap tables can be searched by KeyView directly. C++11's
+// std::unordered_map can't do that, so it is searched by std::string
+// reference instead; in both cases, no key is copied per lookup.
+template <typename hashtype>
+class HashMapHasher {
+  public:
+    typedef void is_transparent;
+
+    HashMapHasher( HashFn hash, seed_t seed ) : hash( hash ), seed( seed ) {}
+
+    // phmap's parallel maps default-construct their submaps before
+    // giving them the real hasher.
+    HashMapHasher() : hash( NULL ), seed( 0 ) {}
+
+    size_t operator ()( const KeyView & key ) const {
+        uint8_t out[sizeof(hashtype)];
+        size_t  result = 0;
+
+        hash(key.ptr, key.len, seed, out);
+        memcpy(&result, out, std::min(sizeof(result), sizeof(out)));
+        return result;
+    }
+
+  private:
+    HashFn  hash;
+    seed_t  seed;
+};
+
+struct HashMapKeyEq {
+    typedef void is_transparent;
+
+    bool operator ()( const KeyView & a, const KeyView & b ) const {
+        return (a.len == b.len) && (memcmp(a.ptr, b.ptr, a.len) == 0);
+    }
+};
+
+template <typename hashtype>
+using std_hashmap = std::unordered_map<std::string, int, HashMapHasher<hashtype>, HashMapKeyEq>;
+template <typename hashtype>
+using fast_hashmap = phmap::flat_hash_map<std::string, int, HashMapHasher<hashtype>, HashMapKeyEq>;
+
+// The original tables, through std::function with a shared static
+// output buffer, are still timed so results stay comparable with
+// earlier versions of this test. They are timed first, as they used to
+// be, so they also pay the same first-touch costs as before.
 typedef std::unordered_map<std::string, int,
-        std::function<size_t (const std::string & key)>> std_hashmap;
+        std::function<size_t (const std::string & key)>> legacy_std_hashmap;
 typedef phmap::flat_hash_map<std::string, int,
-        std::function<size_t (const std::string & key)>> fast_hashmap;
+        std::function<size_t (const std::string & key)>> legacy_fast_hashmap;
+
+static std::function<size_t (const std::string & key)> LegacyHasher( HashFn hash, const seed_t seed ) {
+    return [=]( const std::string & key ) {
+               // 256 needed for hasshe2, but only size_t used
+               static char out[256] = { 0 };
+               hash(key.c_str(), key.length(), seed, &out);
+               return *(size_t *)out;
+           };
+}
 
 //-----------------------------------------------------------------------------
+// Each kind of table has its own way of doing a lookup. The legacy
+// tables copy each key, and use operator[] as the original test did.
 
-static double HashMapSpeedTest( HashFn hash, const int hashbits, std::vector<std::string> words,
-        const seed_t seed, const int trials, bool verbose ) {
-    // using phmap::flat_node_hash_map;
-    Rand r( 82762 );
-
-    std_hashmap hashmap( words.size(), [=]( const std::string & key ) {
-            // 256 needed for hasshe2, but only size_t used
-            static char out[256] = { 0 };
-            hash(key.c_str(), key.length(), seed, &out);
-            return *(size_t *)out;
-        } );
-    fast_hashmap phashmap( words.size(), [=]( const std::string & key ) {
-            // 256 for hasshe2, but stripped to 64/32
-            static char out[256] = { 0 };
-            hash(key.c_str(), key.length(), seed, &out);
-            return *(size_t *)out;
-        } );
-
-    std::vector<std::string>::iterator it;
-    std::vector<double> times;
-    double t1;
+template <typename hashtype>
+static inline bool HashMapLookup( std_hashmap<hashtype> & map, const std::string & key ) {
+    auto it = map.find(key);
 
-    printf("std::unordered_map\n"      );
-    printf("Init std HashMapTest:     ");
-    fflush(NULL);
-    times.reserve(trials);
-    if (0 /*need_minlen64_align16(pfhash)*/) {
-        for (it = words.begin(); it != words.end(); it++) {
-            // requires min len 64, and 16byte key alignment
-            (*it).resize(64);
-        }
+    return (it != map.end()) && it->second;
+}
+
+template <typename hashtype>
+static inline bool HashMapLookup( fast_hashmap<hashtype> & map, const std::string & key ) {
+    auto it = map.find(KeyView(key));
+
+    return (it != map.end()) && it->second;
+}
+
+template <typename map_t>
+static inline bool HashMapLegacyLookup( map_t & map, const std::string & key ) {
+    std::string line = key;
+
+    return map[line] != 0;
+}
+
+static inline bool HashMapLookup( legacy_std_hashmap & map, const std::string & key ) {
+    return HashMapLegacyLookup(map, key);
+}
+
+static inline bool HashMapLookup( legacy_fast_hashmap & map, const std::string & key ) {
+    return HashMapLegacyLookup(map, key);
+}
+
+//-----------------------------------------------------------------------------
+// Probe statistics. A hash can be fast and still make a slow table, if
+// the bits a table actually uses are weak. phmap takes the low 7 bits
+// of the (mixed) hash as a tag (H2) stored in each slot's control byte,
+// and the rest (H1) to pick the first 16-slot group to search, so weak
+// low or high bits show up as extra groups probed, or as tag matches
+// which aren't the key being searched for. std::unordered_map takes the
+// hash modulo its bucket count, so weak bits show up as long chains.
+// These are what the low-bits collision counts from the quality tests
+// cost in practice.
+//
+// The statistics are gathered by walking each table after the timed
+// lookups are done, so the timings are unaffected.
+
+struct HashMapProbeStats {
+    std::vector<uint32_t> probes;   // per lookup: groups probed (phmap), or key compares (std)
+    std::vector<uint32_t> chains;   // std only: length of every non-empty bucket's chain
+    uint64_t              falsepos; // phmap only: tag matches which weren't the key
+    size_t                buckets;  // std only: bucket count
+
+    HashMapProbeStats() : falsepos( 0 ), buckets( 0 ) {}
+};
+
+// This partial specialization of phmap's debugging hook gets the same
+// private access to the table as phmap's own GetNumProbes(), which
+// only counts the total number of steps taken.
+struct HashMapProbeTag {};
+
+namespace phmap {
+    namespace priv {
+        namespace hashtable_debug_internal {
+            template <typename Set>
+            struct HashtableDebugAccess<Set, HashMapProbeTag> {
+                typedef typename Set::raw_hash_set        Base;
+                typedef typename Base::PolicyTraits       Traits;
+                typedef typename Base::template EqualElement<KeyView> Equal;
+
+                // Returns the number of groups probed, and adds to
+                // falsepos the number of tag matches in them which
+                // weren't the key.
+                static uint32_t GroupsProbed( const Set & map, const KeyView & key, uint64_t & falsepos ) {
+                    const Base & set     = map;
+                    const size_t hashval = set.hash(key);
+                    auto         seq     = set.probe(hashval);
+                    uint32_t     groups  = 1;
+
+                    while (true) {
+                        priv::Group g{ set.ctrl_ + seq.offset() };
+                        for (int i: g.Match((h2_t)priv::H2(hashval))) {
+                            if (Traits::apply(Equal{ key, set.eq_ref() },
+                                    Traits::element(set.slots_ + seq.offset((size_t)i)))) {
+                                return groups;
+                            }
+                            falsepos++;
+                        }
+                        if (g.MatchEmpty()) {
+                            return groups;
+                        }
+                        seq.next();
+                        groups++;
+                    }
+                }
+            };
+        } // namespace hashtable_debug_internal
+    } // namespace priv
+} // namespace phmap
+
+template <typename hashtype>
+static void HashMapProbes( const fast_hashmap<hashtype> & map, const std::vector<std::string> & words,
+        HashMapProbeStats & stats ) {
+    typedef phmap::priv::hashtable_debug_internal::HashtableDebugAccess<fast_hashmap<hashtype>, HashMapProbeTag> access;
+
+    stats.probes.reserve(words.size());
+    for (auto it = words.begin(); it != words.end(); it++) {
+        stats.probes.push_back(access::GroupsProbed(map, KeyView(*it), stats.falsepos));
     }
-    {
-        // hash inserts plus 1% deletes
-        volatile int64_t begin, end;
-        int i = 0;
-        begin = timer_start();
-        for (it = words.begin(); it != words.end(); it++, i++) {
-            std::string line = *it;
-            hashmap[line] = 1;
-            if (i % 100 == 0) {
-                hashmap.erase(line);
+}
+
+template <typename hashtype>
+static void HashMapProbes( const std_hashmap<hashtype> & map, const std::vector<std::string> & words,
+        HashMapProbeStats & stats ) {
+    HashMapKeyEq eq;
+
+    stats.probes.reserve(words.size());
+    for (auto it = words.begin(); it != words.end(); it++) {
+        const size_t bucket   = map.bucket(*it);
+        uint32_t     compares = 0;
+        for (auto bit = map.begin(bucket); bit != map.end(bucket); bit++) {
+            compares++;
+            if (eq(bit->first, *it)) {
+                break;
             }
         }
-        end = timer_end();
-        t1  = (double)(end - begin) / (double)words.size();
-    }
-    fflush(NULL);
-    printf("%0.3f cycles/op (%zu inserts, 1%% deletions)\n", t1, words.size());
-    printf("Running std HashMapTest:  ");
-    if (t1 > 10000.) { // e.g. multiply_shift 459271.700
-        printf("SKIP");
-        return 0.;
+        stats.probes.push_back(compares);
     }
-    fflush(NULL);
 
-    for (int itrial = 0; itrial < trials; itrial++) { // hash query
-        volatile int64_t begin, end;
-        int    i = 0, found = 0;
-        double t;
-        begin = timer_start();
-        for (it = words.begin(); it != words.end(); it++, i++) {
-            std::string line = *it;
-            if (hashmap[line]) {
-                found++;
-            }
+    stats.buckets = map.bucket_count();
+    for (size_t bucket = 0; bucket < stats.buckets; bucket++) {
+        const size_t len = map.bucket_size(bucket);
+        if (len > 0) {
+            stats.chains.push_back(len);
         }
-        end = timer_end();
-        t   = (double)(end - begin) / (double)words.size();
-        if ((found > 0) && (t > 0)) { times.push_back(t); }
     }
-    hashmap.clear();
+}
 
-    std::sort(times.begin(), times.end());
-    FilterOutliers(times);
-    double mean = CalcMean(times);
-    double stdv = CalcStdv(times);
-    printf("%0.3f cycles/op", mean);
-    printf(" (%0.1f stdv)\n", stdv);
+// The legacy tables are only timed.
+template <typename map_t>
+static void HashMapProbes( const map_t & map, const std::vector<std::string> & words, HashMapProbeStats & stats ) {}
 
-    times.clear();
+static void HashMapPrintDist( std::vector<uint32_t> & v ) {
+    uint64_t sum = 0;
+
+    std::sort(v.begin(), v.end());
+    for (auto it = v.begin(); it != v.end(); it++) {
+        sum += *it;
+    }
+    printf("mean %6.3f, p99 %3u, max %3u", (double)sum / (double)v.size(),
+            v[std::min(v.size() - 1, (size_t)(0.99 * v.size()))], v.back());
+}
+
+static void HashMapPrintProbes( const char * name, HashMapProbeStats & stats ) {
+    if (stats.probes.empty()) {
+        return;
+    }
+    const size_t lookups = stats.probes.size();
+    printf("Probes %-4s HashMapTest:   ", name);
+    if (stats.buckets == 0) {
+        HashMapPrintDist(stats.probes);
+        printf(" groups/lookup, %0.4f false tag matches/lookup\n", (double)stats.falsepos / (double)lookups);
+    } else {
+        HashMapPrintDist(stats.probes);
+        printf(" compares/lookup\n");
+        printf("Chains %-4s HashMapTest:   ", name);
+        HashMapPrintDist(stats.chains);
+        printf(" keys/bucket, %5.1f%% of buckets used\n", 100.0 * stats.chains.size() / stats.buckets);
+    }
+}
+
+//-----------------------------------------------------------------------------
+
+struct HashMapTimes {
+    double  init;   // cycles per insert, including the 1% deletes
+    double  mean;   // cycles per lookup
+    double  stdv;
+};
+
+// Returns false if inserts were too slow to bother timing lookups.
+template <typename map_t>
+static bool HashMapTimeOps( map_t & map, const std::vector<std::string> & words, const int trials,
+        PerfCounts * perf, HashMapTimes & result, HashMapProbeStats * probes = NULL ) {
+    std::vector<double> times;
 
-    printf("\ngreg7mdp/parallel-hashmap\n");
-    printf("Init fast HashMapTest:    "   );
-    fflush(NULL);
     times.reserve(trials);
     { // hash inserts and 1% deletes
         volatile int64_t begin, end;
         int i = 0;
         begin = timer_start();
-        for (it = words.begin(); it != words.end(); it++, i++) {
-            std::string line = *it;
-            phashmap[line] = 1;
+        for (auto it = words.begin(); it != words.end(); it++, i++) {
+            map[*it] = 1;
             if (i % 100 == 0) {
-                phashmap.erase(line);
+                map.erase(*it);
             }
         }
         end = timer_end();
-        t1  = (double)(end - begin) / (double)words.size();
+        result.init = (double)(end - begin) / (double)words.size();
     }
-    fflush(NULL);
-    printf("%0.3f cycles/op (%zu inserts, 1%% deletions)\n", t1, words.size());
-    printf("Running fast HashMapTest: ");
-    if (t1 > 10000.) { // e.g. multiply_shift 459271.700
-        printf("SKIP");
-        return 0.;
+    if (result.init > 10000.) { // e.g. multiply_shift 459271.700
+        return false;
+    }
+
+    if (perf != NULL) {
+        PerfCountersStart();
     }
-    fflush(NULL);
     for (int itrial = 0; itrial < trials; itrial++) { // hash query
         volatile int64_t begin, end;
-        int    i = 0, found = 0;
+        int    found = 0;
         double t;
         begin = timer_start();
-        for (it = words.begin(); it != words.end(); it++, i++) {
-            std::string line = *it;
-            if (phashmap[line]) {
+        for (auto it = words.begin(); it != words.end(); it++) {
+            if (HashMapLookup(map, *it)) {
                 found++;
             }
         }
@@ -196,15 +380,90 @@ static double HashMapSpeedTest( HashFn hash, const int hashbits, std::vector<std
         t   = (double)(end - begin) / (double)words.size();
         if ((found > 0) && (t > 0)) { times.push_back(t); }
     }
-    phashmap.clear();
-    fflush(NULL);
+    if (perf != NULL) {
+        PerfCountersStop(*perf);
+    }
+    if (probes != NULL) {
+        HashMapProbes(map, words, *probes);
+    }
+    map.clear();
 
     std::sort(times.begin(), times.end());
     FilterOutliers(times);
-    double mean1 = CalcMean(times);
-    double stdv1 = CalcStdv(times);
-    printf("%0.3f cycles/op", mean1);
-    printf(" (%0.1f stdv) " , stdv1);
+    result.mean = CalcMean(times);
+    result.stdv = CalcStdv(times);
+
+    return true;
+}
+
+static void HashMapPrintHeader( const char * title ) {
+    printf("%-26s %10s %8s  %10s %8s\n", title, "cycles/op", "stdv", "legacy", "stdv");
+}
+
+static void HashMapPrintTimes( const char * name, size_t count, const HashMapTimes & cur, const HashMapTimes & legacy ) {
+    printf("Init %-4s HashMapTest:     %10.3f %8s  %10.3f %8s (%zu inserts, 1%% deletions)\n",
+            name, cur.init, "", legacy.init, "", count);
+    printf("Running %-4s HashMapTest:  %10.3f %8.1f  %10.3f %8.1f",
+            name, cur.mean, cur.stdv, legacy.mean, legacy.stdv);
+}
+
+//-----------------------------------------------------------------------------
+
+// Hardware counter results and probe statistics for the fast hashmap
+// queries are left in fastperf and fastprobes, since they can only be
+// printed after the caller's verdict.
+template <typename hashtype>
+static double HashMapSpeedTest( HashFn hash, std::vector<std::string> & words, const seed_t seed,
+        const int trials, bool verbose, PerfCounts & fastperf, HashMapProbeStats & fastprobes ) {
+    HashMapTimes times, legacytimes;
+    bool         ok;
+
+    if (0 /*need_minlen64_align16(pfhash)*/) {
+        for (auto it = words.begin(); it != words.end(); it++) {
+            // requires min len 64, and 16byte key alignment
+            (*it).resize(64);
+        }
+    }
+
+    HashMapPrintHeader("std::unordered_map");
+    fflush(NULL);
+    PerfCounts        perf;
+    HashMapProbeStats probes;
+    PerfCountsClear(perf);
+    {
+        legacy_std_hashmap hashmap( words.size(), LegacyHasher(hash, seed) );
+        ok = HashMapTimeOps(hashmap, words, trials, NULL, legacytimes);
+    }
+    if (ok) {
+        std_hashmap<hashtype> hashmap( words.size(), HashMapHasher<hashtype>(hash, seed) );
+        ok = HashMapTimeOps(hashmap, words, trials, &perf, times, &probes);
+    }
+    if (!ok) {
+        printf("Running std HashMapTest:  SKIP");
+        return 0.;
+    }
+    HashMapPrintTimes("std", words.size(), times, legacytimes);
+    printf("\n");
+    PerfCountsPrint(perf, "op", (double)trials * words.size(), 0.0);
+    HashMapPrintProbes("std", probes);
+    const double mean = times.mean;
+
+    printf("\n");
+    HashMapPrintHeader("greg7mdp/parallel-hashmap");
+    fflush(NULL);
+    {
+        legacy_fast_hashmap phashmap( words.size(), LegacyHasher(hash, seed) );
+        ok = HashMapTimeOps(phashmap, words, trials, NULL, legacytimes);
+    }
+    if (ok) {
+        fast_hashmap<hashtype> phashmap( words.size(), HashMapHasher<hashtype>(hash, seed) );
+        ok = HashMapTimeOps(phashmap, words, trials, &fastperf, times, &fastprobes);
+    }
+    if (!ok) {
+        printf("Running fast HashMapTest: SKIP");
+        return 0.;
+    }
+    HashMapPrintTimes("fast", words.size(), times, legacytimes);
     fflush(NULL);
 
     return mean;
@@ -212,12 +471,16 @@ static double HashMapSpeedTest( HashFn hash, const int hashbits, std::vector<std
 
 //-----------------------------------------------------------------------------
 
-static bool HashMapImpl( HashFn hash, const int hashbits, std::vector<std::string> words,
-        const seed_t seed, const int trials, bool verbose ) {
-    double mean = 0.0;
+template <typename hashtype>
+static bool HashMapImpl( HashFn hash, std::vector<std::string> & words, const seed_t seed,
+        const int trials, bool verbose ) {
+    double            mean = 0.0;
+    PerfCounts        fastperf;
+    HashMapProbeStats fastprobes;
 
+    PerfCountsClear(fastperf);
     try {
-        mean = HashMapSpeedTest(hash, hashbits, words, seed, trials, verbose);
+        mean = HashMapSpeedTest<hashtype>(hash, words, seed, trials, verbose, fastperf, fastprobes);
     } catch (...) {
         printf(" aborted !!!!\n");
     }
@@ -227,11 +490,14 @@ static bool HashMapImpl( HashFn hash, const int hashbits, std::vector<std::strin
     } else {
         printf(" ....... FAIL\n");
     }
+    PerfCountsPrint(fastperf, "op", (double)trials * words.size(), 0.0);
+    HashMapPrintProbes("fast", fastprobes);
     return true;
 }
 
 //-----------------------------------------------------------------------------
 
+template <typename hashtype>
 bool HashMapTest( const HashInfo * hinfo, const bool verbose, const bool extra ) {
     const HashFn hash   = hinfo->hashFn(g_hashEndian);
     const int    trials = (hinfo->isVerySlow() && !extra) ? 5 : 50;
@@ -252,9 +518,866 @@ bool HashMapTest( const HashInfo * hinfo, const bool verbose, const bool extra )
 
     Rand r( 477537 );
     const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
-    result &= HashMapImpl(hash, hinfo->bits, words, seed, trials, verbose);
+    result &= HashMapImpl<hashtype>(hash, words, seed, trials, verbose);
 
     printf("\n%s\n", result ? "" : g_failstr);
 
     return result;
 }
+
+INSTANTIATE(HashMapTest, HASHTYPELIST);
+
+//-----------------------------------------------------------------------------
+// YCSB-style mixed workloads. Instead of one bulk insert followed by
+// uniform lookups of every key, the tables see a stream of reads,
+// updates, inserts, deletes, and lookups of absent keys, with key
+// popularity following a Zipf distribution. This is closer to what a
+// cache sees, and shows tail latency as well as throughput.
+//
+// The word list is shuffled and split into three parts: the working
+// set, which is loaded before each run (in popularity order, so the
+// shuffle decides which words are popular); a pool of keys for
+// inserts; and a pool of keys which are never inserted, for misses.
+// Deletes remove the oldest key inserted during the run, or if there
+// are none, the least popular key still loaded, so reads of those
+// keys become misses. Inserts cycle through their pool, so very long
+// runs may re-insert keys which are still present.
+
+struct HashMapWorkload {
+    const char *  name;
+    const char *  desc;
+    double        read;    // relative weights of each operation
+    double        update;
+    double        insert;
+    double        remove;
+    double        miss;
+    double        theta;   // Zipf skew of key popularity, in [0, 1); 0 is uniform
+    uint32_t      keys;    // working set size; 0 means half the word list
+};
+
+static const HashMapWorkload hashmap_workloads[] = {
+    { "ycsb-a", "update heavy"                           , 50,  50,  0,  0,  0, 0.99, 0 },
+    { "ycsb-b", "read mostly"                            , 95,   5,  0,  0,  0, 0.99, 0 },
+    { "ycsb-c", "read only"                              , 100,  0,  0,  0,  0, 0.99, 0 },
+    { "cache" , "read-heavy cache traffic, with misses"  , 75,   5,  5,  5, 10, 0.99, 0 },
+    { "churn" , "mostly inserts and deletes"             , 40,   0, 30, 30,  0, 0.50, 0 },
+};
+
+constexpr int HASHMAP_WORKLOAD_OPS = 1000000;
+
+enum HashMapOpType : uint8_t {
+    OP_READ, OP_UPDATE, OP_INSERT, OP_DELETE, OP_MISS
+};
+
+struct HashMapOp {
+    HashMapOpType  type;
+    uint32_t       key;  // index into the shuffled word list
+};
+
+// A workload spec is a comma-separated list of name=value pairs, like
+// "read=80,update=5,insert=5,delete=5,miss=5,theta=0.9,keys=100000".
+// Anything not given is 0, except theta, which defaults to 0.99.
+static bool ParseHashMapWorkload( const char * spec, HashMapWorkload & workload ) {
+    workload = { spec, "custom", 0, 0, 0, 0, 0, 0.99, 0 };
+
+    std::string str( spec );
+    size_t      pos = 0;
+    while (pos <= str.size()) {
+        size_t      end  = std::min(str.find(',', pos), str.size());
+        std::string item = str.substr(pos, end - pos);
+        pos = end + 1;
+
+        char   name[16];
+        double value;
+        char   extra;
+        if (sscanf(item.c_str(), "%15[a-z]=%lf %c", name, &value, &extra) != 2) {
+            printf("Error parsing \"%s\" in hashmap workload \"%s\"\n", item.c_str(), spec);
+            return false;
+        }
+        if (!(value >= 0.0)) {
+            printf("Invalid value for \"%s\" in hashmap workload \"%s\"\n", name, spec);
+            return false;
+        }
+        if (strcmp(name, "read"  ) == 0) { workload.read   = value; continue; }
+        if (strcmp(name, "update") == 0) { workload.update = value; continue; }
+        if (strcmp(name, "insert") == 0) { workload.insert = value; continue; }
+        if (strcmp(name, "delete") == 0) { workload.remove = value; continue; }
+        if (strcmp(name, "miss"  ) == 0) { workload.miss   = value; continue; }
+        if (strcmp(name, "keys"  ) == 0) { workload.keys   = (uint32_t)value; continue; }
+        if (strcmp(name, "theta" ) == 0) {
+            if (value >= 1.0) {
+                printf("Zipf theta must be less than 1 in hashmap workload \"%s\"\n", spec);
+                return false;
+            }
+            workload.theta = value;
+            continue;
+        }
+        printf("Unknown parameter \"%s\" in hashmap workload \"%s\"\n", name, spec);
+        return false;
+    }
+
+    if ((workload.read + workload.update + workload.insert + workload.remove + workload.miss) <= 0.0) {
+        printf("Hashmap workload \"%s\" has no operations\n", spec);
+        return false;
+    }
+
+    return true;
+}
+
+// A uniform double in [0, 1)
+static double RandUnit( Rand & r ) {
+    return (double)(r.rand_u64() >> 11) / 9007199254740992.0;
+}
+
+// Gray et al.'s Zipf generator, as used by YCSB. This returns ranks in
+// [0, n), where rank 0 is the most popular.
+class ZipfGenerator {
+  public:
+    ZipfGenerator( uint32_t n, double theta ) : n( n ), theta( theta ) {
+        double zeta2 = 1.0 + pow(0.5, theta);
+
+        zetan = 0.0;
+        for (uint32_t i = 1; i <= n; i++) {
+            zetan += 1.0 / pow((double)i, theta);
+        }
+        alpha = 1.0 / (1.0 - theta);
+        eta   = (1.0 - pow(2.0 / n, 1.0 - theta)) / (1.0 - zeta2 / zetan);
+    }
+
+    uint32_t next( Rand & r ) const {
+        const double u  = RandUnit(r);
+        const double uz = u * zetan;
+
+        if (uz < 1.0) {
+            return 0;
+        }
+        if (uz < (1.0 + pow(0.5, theta))) {
+            return 1;
+        }
+        return std::min((uint32_t)(n * pow(eta * u - eta + 1.0, alpha)), n - 1);
+    }
+
+  private:
+    uint32_t  n;
+    double    theta, zetan, alpha, eta;
+};
+
+static void MakeHashMapOps( std::vector<HashMapOp> & ops, const HashMapWorkload & workload, uint32_t keys,
+        uint32_t insertpool, uint32_t misspool, Rand & r ) {
+    const ZipfGenerator zipf( keys, workload.theta );
+    const double        weights[5] = {
+        workload.read, workload.update, workload.insert, workload.remove, workload.miss
+    };
+    const double        total      = weights[0] + weights[1] + weights[2] + weights[3] + weights[4];
+
+    std::vector<uint32_t> inserted;
+    size_t   oldest    = 0;
+    uint32_t nextins   = 0;
+    uint32_t nextevict = keys;
+
+    for (HashMapOp & op: ops) {
+        double pick = RandUnit(r) * total;
+        int    type = 0;
+        while ((type < 4) && (pick >= weights[type])) {
+            pick -= weights[type++];
+        }
+        while (weights[type] == 0.0) {
+            type--;
+        }
+        op.type = (HashMapOpType)type;
+
+        switch (op.type) {
+        case OP_READ:
+        case OP_UPDATE:
+            op.key = zipf.next(r);
+            break;
+        case OP_INSERT:
+            op.key  = keys + (nextins++ % insertpool);
+            inserted.push_back(op.key);
+            break;
+        case OP_DELETE:
+            if (oldest < inserted.size()) {
+                op.key = inserted[oldest++];
+            } else {
+                nextevict = (nextevict == 0) ? keys - 1 : nextevict - 1;
+                op.key    = nextevict;
+            }
+            break;
+        case OP_MISS:
+            op.key = keys + insertpool + r.rand_range(misspool);
+            break;
+        }
+    }
+}
+
+template <typename map_t>
+static inline bool HashMapDoOp( map_t & map, const HashMapOp & op, const std::vector<std::string> & words ) {
+    const std::string & key = words[op.key];
+
+    switch (op.type) {
+    case OP_READ:
+    case OP_MISS:
+        return HashMapLookup(map, key);
+    case OP_UPDATE:
+    {
+        auto it = map.find(key);
+        if (it == map.end()) {
+            return false;
+        }
+        it->second++;
+        return true;
+    }
+    case OP_INSERT:
+        return map.emplace(key, 1).second;
+    case OP_DELETE:
+        return map.erase(key) != 0;
+    }
+    return false;
+}
+
+struct HashMapWorkloadResult {
+    double               cycles;   // per op, over the whole stream
+    std::vector<double>  latency;  // cycles for each op, sorted
+};
+
+// The stream is run twice on freshly loaded tables: once timed as a
+// whole for throughput, and once timing every op for the latency
+// distribution, since per-op timing costs more than some ops do. The
+// timer serializes execution, so each latency is for an op run in
+// isolation, without the overlap with its neighbours' cache misses
+// which the throughput figure includes.
+template <typename map_t>
+static void HashMapRunWorkload( map_t & map, const std::vector<std::string> & words, uint32_t keys,
+        const std::vector<HashMapOp> & ops, HashMapWorkloadResult & result ) {
+    const double overhead = GetTimerInfo().overhead;
+    volatile int sink;
+    int          found    = 0;
+
+    for (int pass = 0; pass < 2; pass++) {
+        map.clear();
+        for (uint32_t i = 0; i < keys; i++) {
+            map.emplace(words[i], 1);
+        }
+        if (pass == 0) {
+            volatile int64_t begin, end;
+            begin = timer_start();
+            for (const HashMapOp & op: ops) {
+                found += HashMapDoOp(map, op, words);
+            }
+            end = timer_end();
+            result.cycles = (double)(end - begin) / (double)ops.size();
+        } else {
+            result.latency.resize(ops.size());
+            for (size_t i = 0; i < ops.size(); i++) {
+                volatile int64_t begin, end;
+                begin = timer_start();
+                found += HashMapDoOp(map, ops[i], words);
+                end   = timer_end();
+                result.latency[i] = std::max((double)(end - begin) - overhead, 0.0);
+            }
+            std::sort(result.latency.begin(), result.latency.end());
+        }
+    }
+    map.clear();
+    sink = found;
+    (void)sink;
+}
+
+static void HashMapPrintWorkloadResult( const char * name, const HashMapWorkloadResult & result ) {
+    const double   ghz        = GetTimerInfo().ticks_per_ns;
+    const size_t   n          = result.latency.size();
+    const double   pcts[]     = { 0.50, 0.90, 0.99, 0.999 };
+
+    printf("  %-26s %8.3f %9.1f ", name, ghz * 1000.0 / result.cycles, result.cycles / ghz);
+    for (double pct: pcts) {
+        printf(" %8.1f", result.latency[std::min((size_t)(pct * n), n - 1)] / ghz);
+    }
+    printf(" %9.1f\n", result.latency[n - 1] / ghz);
+}
+
+template <typename hashtype>
+static void HashMapWorkloadImpl( const HashInfo * hinfo, const seed_t seed, const HashMapWorkload & workload,
+        const std::vector<std::string> & words ) {
+    const HashFn   hash       = hinfo->hashFn(g_hashEndian);
+    const int      nops       = hinfo->isVerySlow() ? HASHMAP_WORKLOAD_OPS / 16 :
+                                (hinfo->isSlow() ? HASHMAP_WORKLOAD_OPS / 4 : HASHMAP_WORKLOAD_OPS);
+    const uint32_t maxkeys    = words.size() / 2;
+    const uint32_t keys       = ((workload.keys == 0) || (workload.keys > maxkeys)) ? maxkeys : workload.keys;
+    const uint32_t insertpool = (words.size() - keys) / 2;
+    const uint32_t misspool   = words.size() - keys - insertpool;
+    const double   total      = workload.read + workload.update + workload.insert + workload.remove + workload.miss;
+
+    Rand r( 918237 );
+    std::vector<HashMapOp> ops( nops );
+    MakeHashMapOps(ops, workload, keys, insertpool, misspool, r);
+
+    printf("%s - %s\n", workload.name, workload.desc);
+    printf("  (%.0f%% read, %.0f%% update, %.0f%% insert, %.0f%% delete, %.0f%% miss, "
+            "Zipf theta %.2f, %u keys, %d ops)\n", 100.0 * workload.read / total, 100.0 * workload.update / total,
+            100.0 * workload.insert / total, 100.0 * workload.remove / total, 100.0 * workload.miss / total,
+            workload.theta, keys, nops);
+    printf("  %-26s %8s %9s  %8s %8s %8s %8s %9s\n", "", "Mops/sec", "ns/op", "p50 ns", "p90 ns", "p99 ns",
+            "p99.9 ns", "max ns");
+
+    HashMapWorkloadResult result;
+    {
+        std_hashmap<hashtype> hashmap( keys, HashMapHasher<hashtype>(hash, seed) );
+        HashMapRunWorkload(hashmap, words, keys, ops, result);
+        HashMapPrintWorkloadResult("std::unordered_map", result);
+    }
+    {
+        fast_hashmap<hashtype> phashmap( keys, HashMapHasher<hashtype>(hash, seed) );
+        HashMapRunWorkload(phashmap, words, keys, ops, result);
+        HashMapPrintWorkloadResult("phmap::flat_hash_map", result);
+    }
+    printf("\n");
+    fflush(NULL);
+}
+
+// workload is a built-in workload name or a workload spec. If it is
+// NULL, every built-in workload is run.
+template <typename hashtype>
+void HashMapWorkloadTest( const HashInfo * hinfo, const char * workload ) {
+    printf("[[[ 'Hashmap' Workload Tests ]]]\n\n");
+
+    if (hinfo->isMock()) {
+        printf("Skipping Hashmap workload test; it is designed for true hashes\n\n");
+        return;
+    }
+
+    std::vector<HashMapWorkload> workloads;
+    for (const HashMapWorkload & w: hashmap_workloads) {
+        if ((workload == NULL) || (strcmp(workload, w.name) == 0)) {
+            workloads.push_back(w);
+        }
+    }
+    if (workloads.empty()) {
+        HashMapWorkload w;
+        if (!ParseHashMapWorkload(workload, w)) {
+            printf("Skipping Hashmap workload test\n\n");
+            return;
+        }
+        workloads.push_back(w);
+    }
+
+    std::vector<std::string> words = GetWordlist(true, false);
+    if (words.size() < 16) {
+        printf("WARNING: Hashmap initialization failed! Skipping Hashmap workload test.\n\n");
+        return;
+    }
+
+    Rand r( 626081 );
+    for (size_t i = words.size() - 1; i > 0; i--) {
+        std::swap(words[i], words[r.rand_range(i + 1)]);
+    }
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+
+    for (const HashMapWorkload & w: workloads) {
+        HashMapWorkloadImpl<hashtype>(hinfo, seed, w, words);
+    }
+}
+
+INSTANTIATE(HashMapWorkloadTest, HASHTYPELIST);
+
+//-----------------------------------------------------------------------------
+// Concurrent hashmap test. A phmap::parallel_flat_hash_map is a set of
+// 2**N flat_hash_map submaps, each with its own lock, and each key's
+// submap is chosen from bits 8 and up of its (mixed) hash. Here, 1 to
+// g_NCPU threads insert the word list into one shared table, and then
+// all look up every word, so throughput scaling shows how well the
+// hash spreads lock contention.
+//
+// Since phmap runs the hash through its own mixer before picking a
+// submap, a hash's high bits being weak isn't enough to unbalance the
+// submaps on its own; but a hash with too few distinct outputs, or
+// bits which collide together, does. So the submap loads are also
+// compared against what an ideal random hash would give.
+//
+// As in the SpeedScaling test, threads are pinned to CPUs when
+// possible, and throughput is measured in wall-clock time from a
+// common start until the last thread finishes. Each configuration is
+// run a few times and the best time is kept.
+
+constexpr size_t CONCURRENT_SUBMAPS_LOG2 = 6;
+constexpr int    CONCURRENT_REPS         = 3;
+
+template <typename hashtype>
+using parallel_hashmap = phmap::parallel_flat_hash_map<std::string, int, HashMapHasher<hashtype>, HashMapKeyEq,
+        phmap::priv::Allocator<phmap::priv::Pair<const std::string, int>>, CONCURRENT_SUBMAPS_LOG2, hashmap_mutex>;
+
+struct ConcurrentThread {
+    unsigned  cpu;
+    bool      pinned;
+    uint64_t  endtime;
+};
+
+// Inserting threads each add their own slice of the word list, so the
+// table ends up with every word once. Looking-up threads each search
+// for every word, starting at different places.
+template <typename map_t>
+static void ConcurrentWorker( map_t * map, const std::vector<std::string> * words, const bool lookup,
+        const unsigned id, const unsigned nthreads, ConcurrentThread * state, a_uint & ready, a_bool & go,
+        bool pin ) {
+    const size_t n     = words->size();
+    const size_t start = n * id / nthreads;
+    int          found = 0;
+
+    state->pinned = pin ? PinThreadToCPU(state->cpu) : true;
+
+    ready++;
+    while (!go) {
+#if defined(HAVE_THREADS)
+        std::this_thread::yield();
+#endif
+    }
+
+    if (lookup) {
+        for (size_t i = start; i < n; i++) {
+            found += map->if_contains((*words)[i], []( const int & ) {});
+        }
+        for (size_t i = 0; i < start; i++) {
+            found += map->if_contains((*words)[i], []( const int & ) {});
+        }
+    } else {
+        const size_t end = n * (id + 1) / nthreads;
+        for (size_t i = start; i < end; i++) {
+            found += map->emplace((*words)[i], 1).second;
+        }
+    }
+
+    state->endtime = monotonic_clock();
+    volatile int sink = found;
+    (void)sink;
+}
+
+// Returns the wall-clock time, in ns, for nthreads threads to do their
+// share of the inserts or lookups.
+template <typename map_t>
+static uint64_t ConcurrentRun( map_t & map, const std::vector<std::string> & words, const bool lookup,
+        const unsigned nthreads, const std::vector<unsigned> & cpus, bool & allpinned ) {
+    std::vector<ConcurrentThread> state( nthreads );
+    a_uint ready( 0 );
+    a_bool go( false );
+
+    for (unsigned i = 0; i < nthreads; i++) {
+        state[i].cpu = cpus.empty() ? i : cpus[i % cpus.size()];
+    }
+
+    uint64_t begin;
+#if defined(HAVE_THREADS)
+    std::vector<std::thread> t( nthreads );
+    for (unsigned i = 0; i < nthreads; i++) {
+        t[i] = std::thread {
+            ConcurrentWorker<map_t>, &map, &words, lookup, i, nthreads, &state[i], std::ref(ready), std::ref(go), true
+        };
+    }
+    while (ready < nthreads) {
+        std::this_thread::yield();
+    }
+    begin = monotonic_clock();
+    go    = true;
+    for (unsigned i = 0; i < nthreads; i++) {
+        t[i].join();
+    }
+#else
+    go    = true;
+    begin = monotonic_clock();
+    ConcurrentWorker<map_t>(&map, &words, lookup, 0, 1, &state[0], ready, go, false);
+#endif
+
+    uint64_t end = 0;
+    for (unsigned i = 0; i < nthreads; i++) {
+        end        = std::max(end, state[i].endtime);
+        allpinned &= state[i].pinned;
+    }
+
+    return end - begin;
+}
+
+template <typename hashtype>
+static void ConcurrentSubmapLoad( HashFn hash, const seed_t seed, const std::vector<std::string> & words ) {
+    parallel_hashmap<hashtype> map( 0, HashMapHasher<hashtype>(hash, seed) );
+    const size_t               nsub = map.subcnt();
+    std::vector<uint64_t>      counts( nsub, 0 );
+
+    for (const std::string & word: words) {
+        counts[map.subidx(map.hash(word))]++;
+    }
+
+    const double mean = (double)words.size() / nsub;
+    double       sumsq = 0.0;
+    for (uint64_t count: counts) {
+        sumsq += ((double)count - mean) * ((double)count - mean);
+    }
+    const double stdv  = sqrt(sumsq / nsub);
+    // The spread of a multinomial distribution's counts
+    const double ideal = sqrt(mean * (1.0 - 1.0 / nsub));
+    const auto   range = std::minmax_element(counts.begin(), counts.end());
+
+    printf("Submap load: min %" PRIu64 ", max %" PRIu64 ", mean %.1f keys; max/mean %.3f; "
+            "stdv %.1f (%.2fx an ideal hash's)\n", *range.first, *range.second, mean,
+            (double)*range.second / mean, stdv, stdv / ideal);
+}
+
+template <typename hashtype>
+void HashMapThreadsTest( const HashInfo * hinfo ) {
+    const HashFn hash = hinfo->hashFn(g_hashEndian);
+    const std::vector<unsigned> cpus = GetAllowedCPUs();
+    std::vector<unsigned> threadcounts;
+    bool allpinned = true;
+
+    printf("[[[ 'Hashmap' Threaded Tests ]]]\n\n");
+
+    if (hinfo->isMock()) {
+        printf("Skipping Hashmap threaded test; it is designed for true hashes\n\n");
+        return;
+    }
+
+    std::vector<std::string> words = GetWordlist(true, false);
+    if (!words.size()) {
+        printf("WARNING: Hashmap initialization failed! Skipping Hashmap threaded test.\n\n");
+        return;
+    }
+
+    Rand r( 204816 );
+    for (size_t i = words.size() - 1; i > 0; i--) {
+        std::swap(words[i], words[r.rand_range(i + 1)]);
+    }
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+
+    for (unsigned n = 1; n < g_NCPU; n *= 2) {
+        threadcounts.push_back(n);
+    }
+    threadcounts.push_back(g_NCPU);
+
+    if (!cpus.empty() && (g_NCPU > cpus.size())) {
+        printf("WARNING: testing up to %u threads, but only %zu CPUs are available\n\n",
+                g_NCPU, cpus.size());
+    }
+
+    printf("phmap::parallel_flat_hash_map with %zu submaps, %zu keys\n",
+            parallel_hashmap<hashtype>::subcnt(), words.size());
+    printf("%7s  %16s  %10s  %16s  %10s\n", "Threads", "Insert Mops/sec", "Efficiency",
+            "Lookup Mops/sec", "Efficiency");
+
+    std::vector<double> insrates, lookrates;
+    for (unsigned nthreads: threadcounts) {
+        uint64_t insbest = UINT64_MAX, lookbest = UINT64_MAX;
+        for (int rep = 0; rep < CONCURRENT_REPS; rep++) {
+            parallel_hashmap<hashtype> map( words.size(), HashMapHasher<hashtype>(hash, seed) );
+            insbest  = std::min(insbest , ConcurrentRun(map, words, false, nthreads, cpus, allpinned));
+            // As in the Hashmap test, don't bother with hopelessly slow hashes
+            if (insbest * GetTimerInfo().ticks_per_ns > 10000.0 * words.size()) {
+                printf("SKIP (inserts took over 10000 cycles/op)\n\n");
+                return;
+            }
+            lookbest = std::min(lookbest, ConcurrentRun(map, words, true , nthreads, cpus, allpinned));
+        }
+        insrates.push_back((double)words.size() / ((double)insbest / (double)NSEC_PER_SEC));
+        lookrates.push_back((double)words.size() * nthreads / ((double)lookbest / (double)NSEC_PER_SEC));
+
+        printf("%7u  %16.3f  %9.1f%%  %16.3f  %9.1f%%\n", nthreads,
+                insrates.back() / 1e6, 100.0 * insrates.back() / (insrates[0] * nthreads),
+                lookrates.back() / 1e6, 100.0 * lookrates.back() / (lookrates[0] * nthreads));
+    }
+    printf("\n");
+
+    ConcurrentSubmapLoad<hashtype>(hash, seed, words);
+    printf("\n");
+
+    if (!allpinned) {
+        printf("WARNING: threads could not be pinned to CPUs\n\n");
+    }
+
+    fflush(NULL);
+}
+
+INSTANTIATE(HashMapThreadsTest, HASHTYPELIST);
+
+//-----------------------------------------------------------------------------
+// Large hashmap test. The word list fits in cache, but many real tables
+// hold tens of millions of keys, where nearly every lookup misses the
+// cache and the hash's cost is partly hidden behind memory latency.
+// Here, keys which look like common production keys are generated at a
+// chosen cardinality into one contiguous arena, and the tables hold
+// KeyViews into it, as a table of string_views would, so each probe
+// touches the arena as well as the table.
+//
+// For each family of keys, twice as many keys as requested are made,
+// and only the first half is inserted. The timings are for inserting
+// them in order into a presized table, and then looking up every
+// inserted key, and the same number of absent keys, in random order.
+
+constexpr uint32_t LARGE_DEFAULT_KEYS = 10000000;
+constexpr int      LARGE_REPS         = 3;
+
+struct LargeKeyFamily {
+    const char *  name;
+    const char *  desc;
+    void          (* make)( hugevector<char> & arena, std::vector<size_t> & offsets, uint32_t count, Rand & r );
+};
+
+static void LargeAddKey( hugevector<char> & arena, std::vector<size_t> & offsets, const void * key, size_t len ) {
+    const char * p = (const char *)key;
+
+    offsets.push_back(arena.size());
+    arena.insert(arena.end(), p, p + len);
+}
+
+// Sequential database-style IDs, from a random starting point
+static void LargeMakeID64( hugevector<char> & arena, std::vector<size_t> & offsets, uint32_t count, Rand & r ) {
+    const uint64_t base = r.rand_u64();
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t id = base + i;
+        LargeAddKey(arena, offsets, &id, sizeof(id));
+    }
+}
+
+// Random (version 4) UUIDs, in their usual text form
+static void LargeMakeUUID( hugevector<char> & arena, std::vector<size_t> & offsets, uint32_t count, Rand & r ) {
+    static const char hex[] = "0123456789abcdef";
+    uint8_t bytes[16];
+    char    text[37];
+
+    for (uint32_t i = 0; i < count; i++) {
+        r.rand_p(bytes, sizeof(bytes));
+        bytes[6] = (bytes[6] & 0x0f) | 0x40;
+        bytes[8] = (bytes[8] & 0x3f) | 0x80;
+        char * t = text;
+        for (int j = 0; j < 16; j++) {
+            if ((j == 4) || (j == 6) || (j == 8) || (j == 10)) {
+                *t++ = '-';
+            }
+            *t++ = hex[bytes[j] >> 4];
+            *t++ = hex[bytes[j] & 15];
+        }
+        LargeAddKey(arena, offsets, text, 36);
+    }
+}
+
+// URLs from a small set of hosts and path words, which share long
+// prefixes, ending in a unique ID. The ID is the key's index times an
+// odd constant, modulo 2**40, so every URL is distinct.
+static void LargeMakeURL( hugevector<char> & arena, std::vector<size_t> & offsets, uint32_t count, Rand & r ) {
+    static const char * hosts[] = {
+        "www.example.com", "cdn.example.net", "api.shop.example.org", "static.example.io",
+        "images.example.com", "blog.example.co.uk", "m.example.com", "docs.example.dev",
+    };
+    static const char * words[] = {
+        "products", "users", "images", "articles", "search", "category", "assets", "v1",
+        "v2", "archive", "2023", "2024", "news", "item", "detail", "thumbnails",
+    };
+    char url[256];
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint64_t id  = ((uint64_t)i * UINT64_C(0x9E3779B97F4A7C15)) & ((UINT64_C(1) << 40) - 1);
+        int            len = snprintf(url, sizeof(url), "https://%s/%s/%s/%" PRIu64,
+                hosts[r.rand_range(8)], words[r.rand_range(16)], words[r.rand_range(16)], id);
+        if (r.rand_range(4) == 0) {
+            len += snprintf(url + len, sizeof(url) - len, "?ref=%s", words[r.rand_range(16)]);
+        }
+        LargeAddKey(arena, offsets, url, len);
+    }
+}
+
+// A packed struct of a tenant ID, a few small enum-like fields, and an
+// object ID. The tenant and object IDs together are unique.
+static void LargeMakeComposite( hugevector<char> & arena, std::vector<size_t> & offsets, uint32_t count, Rand & r ) {
+    const uint64_t base = r.rand_u64() >> 16;
+    uint8_t        key[16];
+
+    for (uint32_t i = 0; i < count; i++) {
+        const uint32_t tenant = i % 4096;
+        const uint16_t region = r.rand_range(16);
+        const uint16_t kind   = r.rand_range(8);
+        const uint64_t object = base + i / 4096;
+        memcpy(&key[0] , &tenant, 4);
+        memcpy(&key[4] , &region, 2);
+        memcpy(&key[6] , &kind  , 2);
+        memcpy(&key[8] , &object, 8);
+        LargeAddKey(arena, offsets, key, sizeof(key));
+    }
+}
+
+static const LargeKeyFamily large_families[] = {
+    { "id64"     , "8-byte sequential integer IDs"         , LargeMakeID64      },
+    { "uuid"     , "36-byte text UUIDs"                    , LargeMakeUUID      },
+    { "url"      , "URLs with shared hosts and paths"      , LargeMakeURL       },
+    { "composite", "16-byte packed tenant/type/object keys", LargeMakeComposite },
+};
+
+template <typename hashtype>
+using large_std_hashmap = std::unordered_map<KeyView, uint32_t, HashMapHasher<hashtype>, HashMapKeyEq>;
+template <typename hashtype>
+using large_fast_hashmap = phmap::flat_hash_map<KeyView, uint32_t, HashMapHasher<hashtype>, HashMapKeyEq>;
+
+struct LargeResult {
+    double  build;   // cycles per op
+    double  hit;
+    double  miss;
+    bool    ok;
+};
+
+// Returns cycles per lookup. The sum of the values found is kept, so
+// the lookups can't be optimized away.
+template <typename map_t>
+static double LargeTimeLookups( const map_t & map, const hugevector<KeyView> & keys, const std::vector<uint32_t> & order,
+        size_t first, uint64_t & sum ) {
+    volatile int64_t begin, end;
+
+    begin = timer_start();
+    for (uint32_t idx: order) {
+        auto it = map.find(keys[first + idx]);
+        if (it != map.end()) {
+            sum += it->second + 1;
+        }
+    }
+    end = timer_end();
+
+    return (double)(end - begin) / (double)order.size();
+}
+
+template <typename map_t>
+static void LargeRun( map_t & map, const hugevector<KeyView> & keys, const std::vector<uint32_t> & order,
+        LargeResult & result ) {
+    const uint32_t count = order.size();
+    const uint32_t chunk = 1 << 16;
+    int64_t        elapsed = 0;
+
+    result.ok = false;
+
+    // The build is timed in chunks, so a hash which would take hours
+    // to fill the table can be given up on early.
+    for (uint32_t i = 0; i < count; i += chunk) {
+        const uint32_t   last = std::min(i + chunk, count);
+        volatile int64_t begin, end;
+        begin = timer_start();
+        for (uint32_t j = i; j < last; j++) {
+            map.emplace(keys[j], j);
+        }
+        end      = timer_end();
+        elapsed += end - begin;
+        if ((double)elapsed / (double)last > 10000.) {
+            return;
+        }
+    }
+    result.build = (double)elapsed / (double)count;
+
+    uint64_t sum = 0;
+    result.hit  = 1e300;
+    result.miss = 1e300;
+    for (int rep = 0; rep < LARGE_REPS; rep++) {
+        result.hit  = std::min(result.hit , LargeTimeLookups(map, keys, order, 0    , sum));
+        result.miss = std::min(result.miss, LargeTimeLookups(map, keys, order, count, sum));
+    }
+
+    // Each rep should find every inserted key, and no absent one.
+    if (sum != (uint64_t)LARGE_REPS * ((uint64_t)count * (count + 1) / 2)) {
+        printf("  WARNING: lookups found the wrong set of keys!\n");
+    }
+    result.ok = true;
+}
+
+static void LargePrintResult( const char * name, const LargeResult & result ) {
+    const double ghz = GetTimerInfo().ticks_per_ns;
+
+    if (!result.ok) {
+        printf("  %-22s SKIP (inserts too slow)\n", name);
+        return;
+    }
+    printf("  %-22s %8.3f %8.1f   %8.3f %8.1f   %8.3f %8.1f\n", name,
+            ghz * 1000.0 / result.build, result.build / ghz,
+            ghz * 1000.0 / result.hit  , result.hit   / ghz,
+            ghz * 1000.0 / result.miss , result.miss  / ghz);
+}
+
+template <typename hashtype>
+static void HashMapLargeImpl( const HashInfo * hinfo, const seed_t seed, const LargeKeyFamily & family,
+        const uint32_t count ) {
+    const HashFn        hash = hinfo->hashFn(g_hashEndian);
+    hugevector<char>    arena;
+    std::vector<size_t> offsets;
+    Rand r( 350351 );
+
+    offsets.reserve(2 * (size_t)count);
+    family.make(arena, offsets, 2 * count, r);
+
+    hugevector<KeyView> keys;
+    keys.reserve(offsets.size());
+    for (size_t i = 0; i < offsets.size(); i++) {
+        const size_t end = (i + 1 < offsets.size()) ? offsets[i + 1] : arena.size();
+        keys.push_back(KeyView(&arena[offsets[i]], end - offsets[i]));
+    }
+    std::vector<size_t>().swap(offsets);
+
+    std::vector<uint32_t> order( count );
+    for (uint32_t i = 0; i < count; i++) {
+        order[i] = i;
+    }
+    for (uint32_t i = count - 1; i > 0; i--) {
+        std::swap(order[i], order[r.rand_range(i + 1)]);
+    }
+
+    printf("%s - %s\n", family.name, family.desc);
+    printf("  (%u keys, and as many absent keys, avg len %.1f, %.1f MiB key arena)\n", count,
+            (double)arena.size() / (double)keys.size(), (double)arena.size() / 1048576.0);
+    printf("  %-22s %8s %8s   %8s %8s   %8s %8s\n", "", "build", "", "hit", "", "miss", "");
+    printf("  %-22s %8s %8s   %8s %8s   %8s %8s\n", "", "Mops/sec", "ns/op", "Mops/sec", "ns/op",
+            "Mops/sec", "ns/op");
+    fflush(NULL);
+
+    LargeResult result;
+    {
+        large_std_hashmap<hashtype> hashmap( count, HashMapHasher<hashtype>(hash, seed) );
+        LargeRun(hashmap, keys, order, result);
+        LargePrintResult("std::unordered_map", result);
+    }
+    {
+        large_fast_hashmap<hashtype> phashmap( count, HashMapHasher<hashtype>(hash, seed) );
+        LargeRun(phashmap, keys, order, result);
+        LargePrintResult("phmap::flat_hash_map", result);
+    }
+    printf("\n");
+    fflush(NULL);
+}
+
+// count is the number of keys to insert; if it is 0, a default is
+// chosen based on the hash's speed. keyset is a key family name, or
+// NULL for every family.
+template <typename hashtype>
+void HashMapLargeTest( const HashInfo * hinfo, uint32_t count, const char * keyset ) {
+    printf("[[[ 'Hashmap' Large Tests ]]]\n\n");
+
+    if (hinfo->isMock()) {
+        printf("Skipping Hashmap large test; it is designed for true hashes\n\n");
+        return;
+    }
+
+    bool found = false;
+    for (const LargeKeyFamily & f: large_families) {
+        if ((keyset == NULL) || (strcmp(keyset, f.name) == 0)) {
+            found = true;
+        }
+    }
+    if (!found) {
+        printf("Unknown hashmap keyset \"%s\"; skipping Hashmap large test\n\n", keyset);
+        return;
+    }
+
+    if (count == 0) {
+        count = hinfo->isVerySlow() ? LARGE_DEFAULT_KEYS / 16 :
+                (hinfo->isSlow() ? LARGE_DEFAULT_KEYS / 4 : LARGE_DEFAULT_KEYS);
+    }
+
+    Rand r( 180547 );
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+
+    for (const LargeKeyFamily & f: large_families) {
+        if ((keyset == NULL) || (strcmp(keyset, f.name) == 0)) {
+            HashMapLargeImpl<hashtype>(hinfo, seed, f, count);
+        }
+    }
+}
+
+INSTANTIATE(HashMapLargeTest, HASHTYPELIST);
@@ -45,4 +45,14 @@
 
 std::vector<std::string> HashMapInit( bool verbose );
 
+template <typename hashtype>
 bool HashMapTest( const HashInfo * info, const bool verbose, const bool extra );
+
+template <typename hashtype>
+void HashMapWorkloadTest( const HashInfo * info, const char * workload );
+
+template <typename hashtype>
+void HashMapThreadsTest( const HashInfo * info );
+
+template <typename hashtype>
+void HashMapLargeTest( const HashInfo * info, uint32_t count, const char * keyset );
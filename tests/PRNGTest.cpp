@@ -59,7 +59,7 @@
 // Keyset 'Prng'
 
 template <typename hashtype>
-static void Prn_gen( int nbRn, HashFn hash, const seed_t seed, std::vector<hashtype> & hashes ) {
+static void Prn_gen( int nbRn, HashFn hash, const seed_t seed, hugevector<hashtype> & hashes ) {
     assert(nbRn > 0);
 
     printf("Generating random numbers by hashing previous output - %d keys\n", nbRn);
@@ -88,7 +88,7 @@ template <typename hashtype>
 bool PRNGTest( const HashInfo * hinfo, const bool verbose, const bool extra ) {
     const HashFn hash   = hinfo->hashFn(g_hashEndian);
     bool         result = true;
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     printf("[[[ PRNG Tests (deprecated) ]]]\n\n");
 
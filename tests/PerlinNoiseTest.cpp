@@ -69,7 +69,7 @@ static bool PerlinNoise( int Xbits, int Ybits, int inputLen, int step,
     assert(inputLen * 8 > Xbits     ); // enough space to run the test
     assert(inputLen <= INPUT_LEN_MAX);
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     uint8_t      key[INPUT_LEN_MAX] = { 0 };
     int const    xMax = (1 << Xbits);
     int const    yMax = (1 << Ybits);
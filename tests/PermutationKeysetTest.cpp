@@ -60,7 +60,7 @@
 
 template <typename hashtype>
 static void CombinationKeygenRecurse( uint8_t * key, int len, int maxlen, const uint8_t * blocks, uint32_t blockcount,
-        uint32_t blocksz, HashFn hash, const seed_t seed, std::vector<hashtype> & hashes ) {
+        uint32_t blocksz, HashFn hash, const seed_t seed, hugevector<hashtype> & hashes ) {
     if (len == maxlen) { return; } // end recursion
 
     for (int i = 0; i < blockcount; i++) {
@@ -82,7 +82,7 @@ static bool CombinationKeyTest( HashFn hash, const seed_t seed, int maxlen, cons
 
     //----------
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     uint8_t * key = new uint8_t[maxlen * blocksz];
 
@@ -80,7 +80,7 @@ static uint8_t * SeedBlockLenTest_Impl3( const HashFn hash, uint8_t * hashptr, s
 
 // Level 2: Iterate over the seed and block values
 template <typename hashtype, size_t blocklen, bool bigseed>
-static void SeedBlockLenTest_Impl2( const HashInfo * hinfo, std::vector<hashtype> & hashes,
+static void SeedBlockLenTest_Impl2( const HashInfo * hinfo, hugevector<hashtype> & hashes,
         size_t keylen, size_t blockoffset_min, size_t blockoffset_incr, size_t blockoffset_max,
         size_t seedmaxbits, size_t blockmaxbits ) {
     const HashFn hash    = hinfo->hashFn(g_hashEndian);
@@ -155,7 +155,7 @@ static bool SeedBlockLenTest_Impl1( const HashInfo * hinfo, size_t blockoffset_m
     if ((totaltests < 10000) || (totaltests > 110000000)) { printf("Skipping\n\n"); return true; }
 
     // Reserve memory for the hashes
-    std::vector<hashtype> hashes( totaltests );
+    hugevector<hashtype> hashes( totaltests );
 
     // Generate the hashes, test them, and record the results
     if (hinfo->is32BitSeed()) {
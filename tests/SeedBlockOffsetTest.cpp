@@ -77,7 +77,7 @@ static uint8_t * SeedBlockOffsetTest_Impl3( const HashFn hash, uint8_t * hashptr
 
 // Level 2: Iterate over the seed and block values
 template <typename hashtype, size_t blocklen, bool bigseed>
-static void SeedBlockOffsetTest_Impl2( const HashInfo * hinfo, std::vector<hashtype> & hashes, size_t keylen_min,
+static void SeedBlockOffsetTest_Impl2( const HashInfo * hinfo, hugevector<hashtype> & hashes, size_t keylen_min,
         size_t keylen_max, size_t blockoffset, size_t seedmaxbits, size_t blockmaxbits ) {
     const HashFn hash    = hinfo->hashFn(g_hashEndian);
     uint8_t *    hashptr = (uint8_t *)&hashes[0];
@@ -138,7 +138,7 @@ static bool SeedBlockOffsetTest_Impl1( const HashInfo * hinfo, size_t keylen_min
     if ((totaltests < 10000) || (totaltests > 110000000)) { printf("Skipping\n\n"); return true; }
 
     // Reserve memory for the hashes
-    std::vector<hashtype> hashes( totaltests );
+    hugevector<hashtype> hashes( totaltests );
 
     // Generate the hashes, test them, and record the results
     if (hinfo->is32BitSeed()) {
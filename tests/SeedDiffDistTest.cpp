@@ -71,12 +71,12 @@ static bool SeedDiffDistTest( const HashInfo * hinfo, bool drawDiagram ) {
     const int keycount = 512 * 1024 * (ckuniq ? 2 : 3);
     keytype   k;
 
-    std::vector<hashtype> worsthashes;
+    hugevector<hashtype> worsthashes;
     int worstlogp    = -1;
     int worstseedbit = -1;
     int fails        =  0;
 
-    std::vector<hashtype> hashes( keycount );
+    hugevector<hashtype> hashes( keycount );
     hashtype h1, h2;
 
     std::unordered_set<uint64_t> seenkeys;
@@ -0,0 +1,183 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "Platform.h"
+
+#include <string>
+
+#include "Timing.h"
+#include "Hashinfo.h"
+#include "TestGlobals.h"
+#include "Stats.h" // For FilterOutliers, CalcMean, CalcStdv
+#include "Random.h"
+#include "SysInfo.h"
+#include "SpeedBaseline.h"
+
+#include "SeedSpeedTest.h"
+
+//-----------------------------------------------------------------------------
+// Cost of HashInfo::Init() and HashInfo::Seed(). Several hashes do
+// real work in these (building tables, or deriving keys from the
+// seed), and applications which reseed per connection or per shard
+// pay that cost every time.
+//
+// This is functionally a speed test, and so will not inform VCodes,
+// since that would affect results too much.
+
+constexpr int    SEED_BATCH     = 16;   // Reseeds per timing
+constexpr int    SEED_TRIALS    = 200;
+constexpr int    HASH_BATCH     = 1024; // Hashes per timing
+constexpr int    HASH_TRIALS    = 200;
+constexpr int    HASH_KEYLEN    = 16;
+constexpr int    INIT_TRIALS    = 100;  // Repeated Init() calls
+
+static const unsigned keys_per_seed[] = { 1, 10, 100, 1000, 10000 };
+
+//-----------------------------------------------------------------------------
+// The seed results are summed into a volatile, so that the compiler
+// can't skip any of the Seed() calls.
+NEVER_INLINE static int64_t timeseed( const HashInfo * hinfo, const seed_t * seeds ) {
+    volatile int64_t begin, end;
+    volatile seed_t  sink;
+    seed_t           sum = 0;
+
+    begin = timer_start();
+
+    for (int i = 0; i < SEED_BATCH; i++) {
+        sum += hinfo->Seed(seeds[i]);
+    }
+
+    end = timer_end();
+
+    sink = sum;
+    return end - begin;
+}
+
+NEVER_INLINE static int64_t timehash_batch( HashFn hash, const seed_t seed, const uint8_t * keys ) {
+    volatile int64_t begin, end;
+    uint32_t         hash_temp[64] = { 0 };
+
+    begin = timer_start();
+
+    for (int i = 0; i < HASH_BATCH; i++) {
+        hash(&keys[(i & 255) * HASH_KEYLEN], HASH_KEYLEN, seed, hash_temp);
+    }
+
+    end = timer_end();
+
+    return end - begin;
+}
+
+static void Summarize( std::vector<double> & timevec, double & mean, double & stdv ) {
+    std::sort(timevec.begin(), timevec.end());
+    FilterOutliers(timevec);
+    mean = CalcMean(timevec, 0, timevec.size() / 2);
+    stdv = CalcStdv(timevec);
+}
+
+// Mean cycles per Seed() call
+static double SeedCycles( const HashInfo * hinfo, int trials, double & stdv ) {
+    const double        overhead = GetTimerInfo().overhead;
+    std::vector<double> timevec;
+    seed_t              seeds[SEED_BATCH];
+    Rand                r( 839716 );
+
+    timevec.reserve(trials);
+    for (int i = 0; i < trials; i++) {
+        for (int j = 0; j < SEED_BATCH; j++) {
+            seeds[j] = r.rand_u64();
+        }
+        timevec.push_back(std::max((double)timeseed(hinfo, seeds) - overhead, 0.0) / SEED_BATCH);
+    }
+
+    double mean;
+    Summarize(timevec, mean, stdv);
+    return mean;
+}
+
+static int SeedTrials( const HashInfo * hinfo ) {
+    return hinfo->isVerySlow() ? SEED_TRIALS / 16 : (hinfo->isSlow() ? SEED_TRIALS / 4 : SEED_TRIALS);
+}
+
+// A quicker measurement, for the SpeedAll summary table
+double ReseedCycles( const HashInfo * hinfo ) {
+    double stdv;
+
+    return SeedCycles(hinfo, SeedTrials(hinfo) / 4, stdv);
+}
+
+//-----------------------------------------------------------------------------
+// initcycles is how long the first Init() call took, which only the
+// caller can measure, since Init() must happen before any other test.
+
+bool SeedSpeedTest( const HashInfo * hinfo, uint64_t initcycles ) {
+    const HashFn hash = hinfo->hashFn(g_hashEndian);
+    const double ghz  = GetTimerInfo().ticks_per_ns;
+    Rand         r( 750215 );
+
+    printf("[[[ Seed Speed Tests ]]]\n\n");
+
+    const double overhead = GetTimerInfo().overhead;
+    std::vector<double> timevec;
+    double reinit, reinitstdv;
+
+    for (int i = 0; i < INIT_TRIALS; i++) {
+        uint64_t begin = timer_start();
+        hinfo->Init();
+        uint64_t end   = timer_end();
+        timevec.push_back(std::max((double)(end - begin) - overhead, 0.0));
+    }
+    Summarize(timevec, reinit, reinitstdv);
+    timevec.clear();
+
+    printf("Init()            - %12.0f cycles %12.2f us first call, %.0f cycles repeated\n",
+            std::max((double)initcycles - overhead, 0.0), std::max((double)initcycles - overhead, 0.0) / ghz / 1000.0,
+            reinit);
+
+    // Warm up, then measure
+    double stdv;
+    SeedCycles(hinfo, SEED_TRIALS / 16, stdv);
+    const double seedcycles = SeedCycles(hinfo, SeedTrials(hinfo), stdv);
+    printf("Seed()            - %12.2f cycles %12.2f ns per reseed (%8.4f%% stdv)\n",
+            seedcycles, seedcycles / ghz, (seedcycles > 0.0) ? 100.0 * stdv / seedcycles : 0.0);
+    SpeedBaselineRecord(hinfo->name, "Seed/reseed", seedcycles, stdv);
+
+    // Time the hash itself on independent keys, for the amortized costs
+    uint8_t keys[256 * HASH_KEYLEN];
+    r.rand_p(keys, sizeof(keys));
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+
+    volatile int64_t warmuphash = timehash_batch(hash, seed, keys);
+    for (int i = 0; i < HASH_TRIALS; i++) {
+        timevec.push_back(std::max((double)timehash_batch(hash, seed, keys) - overhead, 0.0) / HASH_BATCH);
+    }
+    double hashcycles, hashstdv;
+    Summarize(timevec, hashcycles, hashstdv);
+
+    printf("\nAmortized cost per hash of %d-byte keys (%.2f cycles/hash without reseeding)\n",
+            HASH_KEYLEN, hashcycles);
+    for (unsigned keys_per: keys_per_seed) {
+        const double total = hashcycles + seedcycles / keys_per;
+        printf("  %5u hashes per seed - %10.2f cycles/hash %10.2f ns (reseeding is %5.1f%%)\n",
+                keys_per, total, total / ghz, (total > 0.0) ? 100.0 * (seedcycles / keys_per) / total : 0.0);
+    }
+    printf("\n");
+
+    fflush(NULL);
+    return true;
+}
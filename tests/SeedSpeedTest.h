@@ -0,0 +1,20 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+bool SeedSpeedTest( const HashInfo * hinfo, uint64_t initcycles );
+double ReseedCycles( const HashInfo * hinfo );
@@ -86,7 +86,7 @@ static bool SeedTestImpl( const HashInfo * hinfo, uint32_t keylen, bool drawDiag
 
     //----------
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     hashes.resize(totalkeys);
 
@@ -136,7 +136,7 @@ static bool SeedSparseTestImpl( const HashInfo * hinfo, uint32_t keylen, bool dr
 
     //----------
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     hashes.resize(totalkeys);
 
     seed_t seed;
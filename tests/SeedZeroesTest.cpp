@@ -76,7 +76,7 @@ static bool SeedZeroKeyImpl( const HashInfo * hinfo, const size_t maxbits, const
     addVCodeInput(nullblock, keycount);
 
     //----------
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     hashes.resize(totalkeys);
 
     size_t cnt = 0;
@@ -60,7 +60,7 @@
 
 template <typename keytype, typename hashtype>
 static void SparseKeygenRecurse( HashFn hash, const seed_t seed, int start, int bitsleft,
-        bool inclusive, keytype & k, std::vector<hashtype> & hashes ) {
+        bool inclusive, keytype & k, hugevector<hashtype> & hashes ) {
     const int nbytes = sizeof(keytype);
     const int nbits  = nbytes * 8;
 
@@ -92,7 +92,7 @@ static bool SparseKeyImpl( HashFn hash, const seed_t seed, const int setbits, bo
 
     typedef Blob<keybits> keytype;
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     keytype k;
     memset(&k, 0, sizeof(k));
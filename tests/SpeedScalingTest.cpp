@@ -0,0 +1,253 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "Platform.h"
+#include "Timing.h"
+#include "Hashinfo.h"
+#include "TestGlobals.h"
+#include "Random.h"
+#include "SysInfo.h"
+
+#include "SpeedScalingTest.h"
+
+#include <algorithm>
+
+#if defined(HAVE_THREADS)
+  #include <atomic>
+typedef std::atomic<unsigned> a_uint;
+typedef std::atomic<bool>     a_bool;
+#else
+typedef unsigned a_uint;
+typedef bool     a_bool;
+#endif
+
+//-----------------------------------------------------------------------------
+// Aggregate throughput of a hash running on several cores at once.
+//
+// Each workload is run on 1, 2, 4, ... up to g_NCPU threads, each
+// pinned to its own CPU where possible. Every thread does the same
+// fixed amount of work (weak scaling), and they all start together
+// once every thread has set up its buffer. Throughput is measured in
+// wall-clock time, from the common start until the last thread
+// finishes, so it reflects any frequency throttling or shared
+// bandwidth limits. Each configuration is run a few times and the best
+// time is kept.
+//
+// The "stream" workload walks a buffer much larger than the
+// per-thread caches, so that its curve shows where memory bandwidth
+// saturates.
+
+struct ScalingWorkload {
+    const char *  name;
+    size_t        keylen;
+    size_t        buflen; // per thread; 0 means "scale to memory budget"
+};
+
+static const ScalingWorkload workloads[] = {
+    { "Small key",    16,          4096 },
+    { "Bulk",         256 * 1024,  256 * 1024 },
+    { "Stream",       1024 * 1024, 0 },
+};
+
+static const size_t   STREAM_MAX_BUFLEN   = 64 * 1024 * 1024;
+static const size_t   STREAM_TOTAL_BUFLEN = 1024 * 1024 * 1024;
+static const int      SCALING_REPS        = 3;
+static const uint64_t SCALING_TARGET_NS   = 250 * 1000 * 1000;
+
+// Scaling saturates at the first thread count whose throughput is
+// within this factor of the best one seen.
+static const double   SATURATION_GAIN     = 1.05;
+
+struct ScalingThread {
+    unsigned  cpu;
+    bool      pinned;
+    uint64_t  endtime;
+};
+
+static void ScalingWorker( const HashInfo * hinfo, const seed_t rawseed, const ScalingWorkload * work,
+        const size_t buflen, const uint64_t iters, ScalingThread * state, a_uint & ready, a_bool & go, bool pin ) {
+    const HashFn hash = hinfo->hashFn(g_hashEndian);
+    const seed_t seed = hinfo->Seed(rawseed);
+    Rand         r( 739104 + state->cpu );
+
+    std::vector<uint8_t> buf( buflen );
+    uint32_t             out[64] = { 0 };
+    size_t               offset  = 0;
+
+    state->pinned = pin ? PinThreadToCPU(state->cpu) : true;
+    r.rand_p(&buf[0], buflen);
+
+    ready++;
+    while (!go) {
+#if defined(HAVE_THREADS)
+        std::this_thread::yield();
+#endif
+    }
+
+    if (work->keylen < 128) {
+        // As in timehash_small(), each key depends on the previous
+        // hash, so these measure latency-bound small-key hashing.
+        for (uint64_t i = 0; i < iters; i++) {
+            hash(&buf[0], work->keylen, seed, out);
+            uint32_t j = (uint32_t)i ^ out[0];
+            memcpy(&buf[0], &j, 4);
+        }
+    } else {
+        for (uint64_t i = 0; i < iters; i++) {
+            hash(&buf[offset], work->keylen, seed, out);
+            offset += work->keylen;
+            if (offset + work->keylen > buflen) {
+                offset = 0;
+            }
+        }
+    }
+
+    state->endtime = monotonic_clock();
+    // Keep the hashing from being optimized away
+    volatile uint32_t sink = out[0];
+    (void)sink;
+}
+
+// Returns the wall-clock time, in ns, for nthreads threads to each do
+// iters hashes.
+static uint64_t ScalingRun( const HashInfo * hinfo, const seed_t rawseed, const ScalingWorkload * work,
+        const unsigned nthreads, const uint64_t iters, const std::vector<unsigned> & cpus, bool & allpinned ) {
+    std::vector<ScalingThread> state( nthreads );
+    a_uint ready( 0 );
+    a_bool go( false );
+    size_t buflen = work->buflen;
+
+    if (buflen == 0) {
+        buflen = std::min(STREAM_MAX_BUFLEN, STREAM_TOTAL_BUFLEN / nthreads);
+        buflen = std::max(buflen / work->keylen, (size_t)1) * work->keylen;
+    }
+
+    for (unsigned i = 0; i < nthreads; i++) {
+        state[i].cpu = cpus.empty() ? i : cpus[i % cpus.size()];
+    }
+
+    // Threads are always used when available, even for a single one,
+    // so that pinning never sticks to the main thread.
+    uint64_t begin;
+#if defined(HAVE_THREADS)
+    std::vector<std::thread> t( nthreads );
+    for (unsigned i = 0; i < nthreads; i++) {
+        t[i] = std::thread {
+            ScalingWorker, hinfo, rawseed, work, buflen, iters, &state[i], std::ref(ready), std::ref(go), true
+        };
+    }
+    while (ready < nthreads) {
+        std::this_thread::yield();
+    }
+    begin = monotonic_clock();
+    go    = true;
+    for (unsigned i = 0; i < nthreads; i++) {
+        t[i].join();
+    }
+#else
+    go    = true;
+    begin = monotonic_clock();
+    ScalingWorker(hinfo, rawseed, work, buflen, iters, &state[0], ready, go, false);
+#endif
+
+    uint64_t end = 0;
+    for (unsigned i = 0; i < nthreads; i++) {
+        end        = std::max(end, state[i].endtime);
+        allpinned &= state[i].pinned;
+    }
+
+    return end - begin;
+}
+
+static void ScalingTest( const HashInfo * hinfo, const seed_t rawseed, const ScalingWorkload * work,
+        const std::vector<unsigned> & threadcounts, const std::vector<unsigned> & cpus, bool & allpinned ) {
+    const unsigned maxthreads = threadcounts.back();
+
+    // Find a per-thread iteration count which takes about
+    // SCALING_TARGET_NS on one thread.
+    uint64_t iters = (work->keylen < 128) ? 4096 : 1;
+    uint64_t ns;
+    while ((ns = ScalingRun(hinfo, rawseed, work, 1, iters, cpus, allpinned)) < SCALING_TARGET_NS / 8) {
+        iters *= 2;
+    }
+    iters = std::max((uint64_t)1, (uint64_t)((double)iters * SCALING_TARGET_NS / ns));
+
+    printf("%s speed scaling - %zu-byte keys, %" PRIu64 " hashes per thread\n",
+            work->name, work->keylen, iters);
+    printf("%7s  %14s  %12s  %10s\n", "Threads", "Mhashes/sec", "GB/sec", "Efficiency");
+
+    std::vector<double> rates;
+    for (unsigned nthreads: threadcounts) {
+        uint64_t best = UINT64_MAX;
+        for (int rep = 0; rep < SCALING_REPS; rep++) {
+            best = std::min(best, ScalingRun(hinfo, rawseed, work, nthreads, iters, cpus, allpinned));
+        }
+        const double hashes = (double)iters * nthreads;
+        const double rate   = hashes / ((double)best / (double)NSEC_PER_SEC);
+        rates.push_back(rate);
+
+        printf("%7u  %14.3f  %12.3f  %9.1f%%\n", nthreads, rate / 1e6, rate * work->keylen / 1e9,
+                100.0 * rate / (rates[0] * nthreads));
+    }
+
+    const double best = *std::max_element(rates.begin(), rates.end());
+    size_t       sat  = 0;
+    while (rates[sat] * SATURATION_GAIN < best) {
+        sat++;
+    }
+    if ((sat + 1) < rates.size()) {
+        printf("%s throughput saturates at %u threads (%.3f GB/sec)\n", work->keylen >= 1024 * 1024 ?
+                "Memory" : "Aggregate", threadcounts[sat], rates[sat] * work->keylen / 1e9);
+    } else {
+        printf("No saturation seen up to %u threads\n", maxthreads);
+    }
+    printf("\n");
+}
+
+//-----------------------------------------------------------------------------
+bool SpeedScalingTest( const HashInfo * hinfo ) {
+    Rand r( 820355 );
+    const seed_t rawseed = g_seed ^ r.rand_u64();
+    const std::vector<unsigned> cpus = GetAllowedCPUs();
+    std::vector<unsigned> threadcounts;
+    bool allpinned = true;
+
+    printf("[[[ Speed Scaling Tests ]]]\n\n");
+
+    for (unsigned n = 1; n < g_NCPU; n *= 2) {
+        threadcounts.push_back(n);
+    }
+    threadcounts.push_back(g_NCPU);
+
+    if (!cpus.empty() && (g_NCPU > cpus.size())) {
+        printf("WARNING: testing up to %u threads, but only %zu CPUs are available\n\n",
+                g_NCPU, cpus.size());
+    }
+
+    for (const ScalingWorkload & work: workloads) {
+        ScalingTest(hinfo, rawseed, &work, threadcounts, cpus, allpinned);
+    }
+
+    if (!allpinned) {
+        printf("WARNING: threads could not be pinned to CPUs\n\n");
+    }
+
+    fflush(NULL);
+
+    return true;
+}
@@ -52,12 +52,18 @@
 #include "TestGlobals.h"
 #include "Stats.h" // For FilterOutliers, CalcMean, CalcStdv
 #include "Random.h"
+#include "SysInfo.h"
+#include "PerfCounters.h"
+#include "SpeedBaseline.h"
+#include "SeedSpeedTest.h"
 
 #include "SpeedTest.h"
 
 #include <string>
 #include <functional>
 #include <map>
+#include <new>
+#include <cmath>
 
 constexpr int BULK_RUNS   = 16;
 constexpr int BULK_TRIALS = 9600;
@@ -65,6 +71,8 @@ constexpr int BULK_TRIALS = 9600;
 
 constexpr int TINY_TRIALS  = 600;   // Timings per hash for small (<128b) keys
 constexpr int TINY_SAMPLES = 15000; // Samples per timing run for small sizes
+constexpr int TINY_KEYS    = 256;   // Distinct keys for independent-key timing runs
+constexpr int TINY_STRIDE  = 128;   // Spacing between those keys
 
 // std::max() isn't constexpr in C++11
 constexpr int MAX_TRIALS = (BULK_TRIALS > TINY_TRIALS) ? BULK_TRIALS : TINY_TRIALS;
@@ -142,22 +150,104 @@ NEVER_INLINE static uint64_t timehash_small( HashFn hash, const seed_t seed, uin
     return end - begin;
 }
 
+//-----------------------------------------------------------------------------
+// Throughput counterpart to timehash_small(), for independent keys.
+//
+// This hashes a fixed set of distinct keys round-robin, with nothing
+// linking one hash to the next, so an out-of-order CPU is free to
+// overlap consecutive calls. This is closer to hashing a batch of
+// unrelated keys (e.g. hashtable lookups) than the latency-bound
+// timehash_small(), and hashes with long dependency chains but lots of
+// ILP can do much better here.
+//
+// keys must hold TINY_KEYS keys of up to TINY_STRIDE bytes each.
+NEVER_INLINE static uint64_t timehash_small_indep( HashFn hash, const seed_t seed, const uint8_t * const keys, int len ) {
+    volatile unsigned long long int begin, end;
+    uint32_t hash_temp[16] = { 0 };
+
+    begin = timer_start();
+
+    for (int i = 0; i < TINY_SAMPLES; i++) {
+        hash(&keys[(i & (TINY_KEYS - 1)) * TINY_STRIDE], len, seed, hash_temp);
+    }
+
+    end = timer_end();
+
+    return end - begin;
+}
+
+//-----------------------------------------------------------------------------
+// Calibrates the timer (if needed), and says what "cycles" means in
+// the reports that follow.
+static void PrintTimerInfo( void ) {
+    const TimerInfo & info = GetTimerInfo();
+
+    printf("Timer: %.3f ticks/ns, %s, %.1f ticks of timer overhead subtracted\n", info.ticks_per_ns,
+            (info.invariant == 1) ? "invariant TSC" : ((info.invariant == 0) ? "TSC is NOT invariant" :
+            "TSC invariance unknown"), info.overhead);
+    if (info.invariant == 0) {
+        printf("WARNING: cycle counts will vary with the CPU frequency\n");
+    }
+    if ((info.governor[0] != '\0') && (strcmp(info.governor, "performance") != 0)) {
+        printf("WARNING: CPU frequency governor is \"%s\"; results may vary with frequency scaling\n",
+                info.governor);
+    }
+    if (info.spread > 0.01) {
+        printf("WARNING: timer rate varied by %.1f%% during calibration\n", 100.0 * info.spread);
+    }
+    printf("Cycle counts are timer ticks, which may not match the core clock\n\n");
+}
+
+//-----------------------------------------------------------------------------
+// Hardware counter results, if enabled, are added to *perftotals by
+// each SpeedTest() call made while it is set.
+struct PerfTotals {
+    PerfCounts  counts;
+    double      hashes;
+    double      bytes;
+};
+
+static PerfTotals * perftotals = NULL;
+
+static void PerfTotalsClear( PerfTotals & totals ) {
+    PerfCountsClear(totals.counts);
+    totals.hashes = 0.0;
+    totals.bytes  = 0.0;
+}
+
+static void PerfTotalsPrint( const PerfTotals & totals, const char * opname, bool perbyte ) {
+    PerfCountsPrint(totals.counts, opname, totals.hashes, perbyte ? totals.bytes : 0.0);
+}
+
 //-----------------------------------------------------------------------------
 double stddev;
 double rawtimes[MAX_TRIALS];
+
+// With --hugepages, key buffers are backed by huge pages if possible,
+// so that bulk results aren't distorted by dTLB misses. This is the
+// fraction of the last buffer which actually got them, as sampled for
+// buffers of its size.
+static double bufhuge = -1.0;
 std::vector<int> sizes( MAX_TRIALS );
 std::vector<int> alignments( MAX_TRIALS );
 std::map<std::pair<int, int>, std::vector<double>> times;
 
+// If indep is true, small keys are timed with timehash_small_indep()
+// instead of timehash_small().
 static double SpeedTest( HashFn hash, seed_t seed, const int trials, const int blocksize,
-        const int align, const int maxvarysize, const int maxvaryalign ) {
+        const int align, const int maxvarysize, const int maxvaryalign, const bool indep = false ) {
     static uint64_t callcount = 0;
     Rand r( 444793 + (callcount++));
 
-    uint8_t * buf = new uint8_t[blocksize + 512]; // assumes (align + maxvaryalign) <= 257
-    uintptr_t t1  = reinterpret_cast<uintptr_t>(buf);
+    const int bufsize = std::max(blocksize, TINY_KEYS * TINY_STRIDE) + 512;
+    // assumes (align + maxvaryalign) <= 257
+    uint8_t * buf     = HugePagesEnabled() ? (uint8_t *)HugePageAlloc(bufsize) : new uint8_t[bufsize];
+    uintptr_t t1      = reinterpret_cast<uintptr_t>(buf);
 
-    r.rand_p(buf, blocksize + 512);
+    r.rand_p(buf, bufsize);
+    if (HugePagesEnabled()) {
+        bufhuge = HugePageSampleFraction(buf, bufsize);
+    }
     t1  = (t1 + 255) & UINT64_C(0xFFFFFFFFFFFFFF00);
     t1 += align;
 
@@ -184,21 +274,42 @@ static double SpeedTest( HashFn hash, seed_t seed, const int trials, const int b
     }
 
     //----------
+    if (perftotals != NULL) {
+        PerfCountersStart();
+    }
+
+    const double overhead = GetTimerInfo().overhead;
+
     for (int itrial = 0; itrial < trials; itrial++) {
         int       testsize = sizes[itrial];
         uint8_t * block    = reinterpret_cast<uint8_t *>(t1 + alignments[itrial]);
 
         double t;
-        if (testsize < 128) {
-            t = (double)timehash_small(hash, seed, block, testsize) / (double)TINY_SAMPLES;
+        if ((testsize < 128) && indep) {
+            t = ((double)timehash_small_indep(hash, seed, block, testsize) - overhead) / (double)TINY_SAMPLES;
+        } else if (testsize < 128) {
+            t = ((double)timehash_small(hash, seed, block, testsize) - overhead) / (double)TINY_SAMPLES;
         } else {
-            t = (double)timehash(hash      , seed, block, testsize) / (double)2.0;
+            t = ((double)timehash(hash      , seed, block, testsize) - overhead) / (double)2.0;
         }
 
-        rawtimes[itrial] = t;
+        rawtimes[itrial] = std::max(t, 0.0);
+    }
+
+    if (perftotals != NULL) {
+        PerfCountersStop(perftotals->counts);
+        for (int itrial = 0; itrial < trials; itrial++) {
+            const double nhashes = (sizes[itrial] < 128) ? TINY_SAMPLES : 2;
+            perftotals->hashes += nhashes;
+            perftotals->bytes  += nhashes * sizes[itrial];
+        }
     }
 
-    delete [] buf;
+    if (HugePagesEnabled()) {
+        HugePageFree(buf, bufsize);
+    } else {
+        delete [] buf;
+    }
 
     //----------
     for (int itrial = 0; itrial < trials; itrial++) {
@@ -234,6 +345,37 @@ static double SpeedTest( HashFn hash, seed_t seed, const int trials, const int b
     return avgtotal / count;
 }
 
+//-----------------------------------------------------------------------------
+// Rather than trusting a single warm-up run, this repeats shorter runs
+// until two in a row agree to within WARMUP_TOLERANCE, so that caches,
+// branch predictors, and the CPU clock have all settled before any
+// timings are kept. Returns false if they never did.
+
+constexpr int    WARMUP_MAX_RUNS  = 10;
+constexpr double WARMUP_TOLERANCE = 0.02;
+
+static bool WarmUp( HashFn hash, seed_t seed, const int trials, const int blocksize ) {
+    const int warmtrials = std::max(trials / 4, 8);
+    double    prev       = SpeedTest(hash, seed, warmtrials, blocksize, 0, 0, 0);
+
+    for (int i = 1; i < WARMUP_MAX_RUNS; i++) {
+        double cur = SpeedTest(hash, seed, warmtrials, blocksize, 0, 0, 0);
+        if (fabs(cur - prev) <= (WARMUP_TOLERANCE * prev)) {
+            return true;
+        }
+        prev = cur;
+    }
+
+    return false;
+}
+
+static void WarmUpReport( HashFn hash, seed_t seed, const int trials, const int blocksize ) {
+    if (!WarmUp(hash, seed, trials, blocksize)) {
+        printf("WARNING: timings did not settle to within %.0f%% after %d warm-up runs\n",
+                100.0 * WARMUP_TOLERANCE, WARMUP_MAX_RUNS);
+    }
+}
+
 //-----------------------------------------------------------------------------
 // 256k blocks seem to give the best results.
 
@@ -243,6 +385,9 @@ static void BulkSpeedTest( const HashInfo * hinfo, seed_t seed, bool vary_align,
     const int    runcount  = hinfo->isVerySlow() ? BULK_RUNS   / 16 : (hinfo->isSlow() ? BULK_RUNS   / 4 : BULK_RUNS  );
     const int    trials    = hinfo->isVerySlow() ? BULK_TRIALS / 16 : (hinfo->isSlow() ? BULK_TRIALS / 4 : BULK_TRIALS);
     const HashFn hash      = hinfo->hashFn(g_hashEndian);
+    const double ghz       = GetTimerInfo().ticks_per_ns;
+
+    const std::string metric = vary_size ? "BulkVary/" : "Bulk/";
 
     if (vary_size) {
         printf("Bulk speed test - [%d, %d]-byte keys\n", blocksize - maxvary, blocksize);
@@ -251,39 +396,61 @@ static void BulkSpeedTest( const HashInfo * hinfo, seed_t seed, bool vary_align,
     }
     double sumbpc = 0.0;
 
-    volatile double warmup_cycles = SpeedTest(hash, seed, trials, blocksize, 0, 0, 0);
+    WarmUpReport(hash, seed, trials, blocksize);
+    if (HugePagesEnabled()) {
+        if (bufhuge < 0.0) {
+            printf("Key buffer huge page backing is unknown\n");
+        } else if (bufhuge < 1.0) {
+            printf("WARNING: only %.0f%% of the key buffer is backed by huge pages\n", 100.0 * bufhuge);
+        } else {
+            printf("Key buffer is backed by huge pages\n");
+        }
+    }
+
+    PerfTotals perf;
 
     for (int align = 7; align >= 0; align--) {
         double cycles = 0;
+        PerfTotalsClear(perf);
+        perftotals = PerfCountersActive() ? &perf : NULL;
         for (int i = 0; i < runcount; i++) {
             cycles += SpeedTest(hash, seed, trials, blocksize, align, maxvary, 0);
         }
+        perftotals = NULL;
         cycles /= (double)runcount;
 
         double bestbpc = ((double)blocksize - ((double)maxvary / 2)) / cycles;
 
-        double bestbps = (bestbpc * 3000000000.0 / 1048576.0);
-        printf("Alignment  %2d - %6.3f bytes/cycle - %7.2f MiB/sec @ 3 ghz (%10.6f stdv%8.4f%%)\n",
-                align, bestbpc, bestbps, stddev, 100.0 * stddev / cycles);
+        double bestbps = (bestbpc * ghz * 1e9 / 1048576.0);
+        printf("Alignment  %2d - %6.3f bytes/cycle - %8.2f MiB/sec - %7.3f GB/sec (%10.6f stdv%8.4f%%)\n",
+                align, bestbpc, bestbps, bestbpc * ghz, stddev, 100.0 * stddev / cycles);
+        PerfTotalsPrint(perf, "hash", true);
+        SpeedBaselineRecord(hinfo->name, metric + "align" + std::to_string(align), cycles, stddev);
         sumbpc += bestbpc;
     }
 
     sumbpc = sumbpc / 8.0;
-    printf("Average       - %6.3f bytes/cycle - %7.2f MiB/sec @ 3 ghz\n", sumbpc, (sumbpc * 3000000000.0 / 1048576.0));
+    printf("Average       - %6.3f bytes/cycle - %8.2f MiB/sec - %7.3f GB/sec\n", sumbpc,
+            (sumbpc * ghz * 1e9 / 1048576.0), sumbpc * ghz);
 
     // Deliberately not counted in the Average stat, so the two can be directly compared
     if (vary_align) {
         double cycles = 0;
+        PerfTotalsClear(perf);
+        perftotals = PerfCountersActive() ? &perf : NULL;
         for (int i = 0; i < runcount; i++) {
             cycles += SpeedTest(hash, seed, trials, blocksize, 0, maxvary, 7);
         }
+        perftotals = NULL;
         cycles /= (double)runcount;
 
         double bestbpc = ((double)blocksize - ((double)maxvary / 2)) / cycles;
 
-        double bestbps = (bestbpc * 3000000000.0 / 1048576.0);
-        printf("Alignment rnd - %6.3f bytes/cycle - %7.2f MiB/sec @ 3 ghz (%10.6f stdv%8.4f%%)\n",
-                bestbpc, bestbps, stddev, 100.0 * stddev / cycles);
+        double bestbps = (bestbpc * ghz * 1e9 / 1048576.0);
+        printf("Alignment rnd - %6.3f bytes/cycle - %8.2f MiB/sec - %7.3f GB/sec (%10.6f stdv%8.4f%%)\n",
+                bestbpc, bestbps, bestbpc * ghz, stddev, 100.0 * stddev / cycles);
+        PerfTotalsPrint(perf, "hash", true);
+        SpeedBaselineRecord(hinfo->name, metric + "alignrnd", cycles, stddev);
     }
 
     fflush(NULL);
@@ -292,43 +459,749 @@ static void BulkSpeedTest( const HashInfo * hinfo, seed_t seed, bool vary_align,
 //-----------------------------------------------------------------------------
 
 static double TinySpeedTest( const HashInfo * hinfo, int maxkeysize, seed_t seed, bool verbose, bool include_vary ) {
-    const HashFn hash = hinfo->hashFn(g_hashEndian);
-    double       sum  = 0.0;
+    const HashFn hash     = hinfo->hashFn(g_hashEndian);
+    double       sum      = 0.0;
+    double       sumindep = 0.0;
+    const double ghz      = GetTimerInfo().ticks_per_ns;
+
+    printf("Small key speed test - [1, %2d]-byte keys (latency, and throughput over independent keys)\n", maxkeysize);
 
-    printf("Small key speed test - [1, %2d]-byte keys\n", maxkeysize);
+    WarmUpReport(hash, seed, TINY_TRIALS, maxkeysize);
 
-    volatile double warmup_cycles = SpeedTest(hash, seed, TINY_TRIALS, maxkeysize, 0, 0, 0);
+    PerfTotals perf, perfindep;
+    PerfTotalsClear(perf);
+    PerfTotalsClear(perfindep);
 
     for (int i = 1; i <= maxkeysize; i++) {
         volatile int j      = i;
+        perftotals = PerfCountersActive() ? &perf : NULL;
         double       cycles = SpeedTest(hash, seed, TINY_TRIALS, j, 0, 0, 0);
+        double       curdev = stddev;
+        perftotals = PerfCountersActive() ? &perfindep : NULL;
+        double       indep  = SpeedTest(hash, seed, TINY_TRIALS, j, 0, 0, 0, true);
+        double       indepdev = stddev;
+        perftotals = NULL;
+        SpeedBaselineRecord(hinfo->name, "Small/" + std::to_string(j)            , cycles, curdev  );
+        SpeedBaselineRecord(hinfo->name, "Small/" + std::to_string(j) + "/indep", indep , indepdev);
         if (verbose) {
-            printf("  %2d-byte keys - %8.2f cycles/hash (%8.6f stdv%8.4f%%)\n",
-                    j, cycles, stddev, 100.0 * stddev / cycles);
+            printf("  %2d-byte keys - %8.2f cycles/hash %7.2f ns (%8.6f stdv%8.4f%%) - %8.2f cycles/hash %7.2f ns indep\n",
+                    j, cycles, cycles / ghz, curdev, 100.0 * curdev / cycles, indep, indep / ghz);
         }
-        sum += cycles;
+        sum      += cycles;
+        sumindep += indep;
     }
 
-    sum = sum / (double)maxkeysize;
-    printf("Average        - %8.2f cycles/hash\n", sum);
+    sum      = sum / (double)maxkeysize;
+    sumindep = sumindep / (double)maxkeysize;
+    printf("Average        - %8.2f cycles/hash %7.2f ns - %8.2f cycles/hash %7.2f ns indep\n",
+            sum, sum / ghz, sumindep, sumindep / ghz);
+    PerfTotalsPrint(perf     , "hash"      , false);
+    PerfTotalsPrint(perfindep, "indep hash", false);
 
     // Deliberately not counted in the Average stat, so the two can be directly compared
     if (include_vary) {
         double cycles = SpeedTest(hash, seed, TINY_TRIALS, maxkeysize, 0, maxkeysize - 1, 0);
+        double curdev = stddev;
+        double indep  = SpeedTest(hash, seed, TINY_TRIALS, maxkeysize, 0, maxkeysize - 1, 0, true);
+        SpeedBaselineRecord(hinfo->name, "Small/rnd"      , cycles, curdev);
+        SpeedBaselineRecord(hinfo->name, "Small/rnd/indep", indep , stddev);
         if (verbose) {
-            printf(" rnd-byte keys - %8.2f cycles/hash (%8.6f stdv%8.4f%%)\n", cycles, stddev, 100.0 * stddev / cycles);
+            printf(" rnd-byte keys - %8.2f cycles/hash %7.2f ns (%8.6f stdv%8.4f%%) - %8.2f cycles/hash %7.2f ns indep\n",
+                    cycles, cycles / ghz, curdev, 100.0 * curdev / cycles, indep, indep / ghz);
         }
     }
 
     return sum;
 }
 
+//-----------------------------------------------------------------------------
+// Sweeps key lengths on a log scale (2 points per octave) from 32 bytes
+// up to maxlen, to show how speed changes as the key outgrows each
+// level of the cache hierarchy. Each point is labeled with the
+// smallest cache level the key fits in.
+//
+// Every point hashes roughly the same number of total bytes, so large
+// keys get fewer (but at least SWEEP_MIN_TRIALS) timings.
+
+constexpr uint64_t SWEEP_BYTES      = UINT64_C(512) << 20;
+constexpr int      SWEEP_MIN_TRIALS = 8;
+
+void SpeedSweepTest( const HashInfo * hinfo, uint64_t maxlen, SpeedSweepFormat format ) {
+    const HashFn hash     = hinfo->hashFn(g_hashEndian);
+    const int    slowdown = hinfo->isVerySlow() ? 16 : (hinfo->isSlow() ? 4 : 1);
+    const double ghz      = GetTimerInfo().ticks_per_ns;
+    Rand         r( 180116 );
+
+    const std::vector<CacheLevel> caches = GetDataCaches();
+    std::vector<uint64_t>         lens;
+
+    const uint64_t clamped = std::min(std::max(maxlen, (uint64_t)32), (uint64_t)1 << 30);
+    if (clamped != maxlen) {
+        // Keep CSV and JSON output parseable
+        fprintf((format == SWEEP_TEXT) ? stdout : stderr,
+                "WARNING: --sweep-max of %" PRIu64 " bytes is outside 32..1G; using %" PRIu64 "\n",
+                maxlen, clamped);
+        maxlen = clamped;
+    }
+    for (int i = 0;; i++) {
+        uint64_t len = (uint64_t)std::round(32.0 * std::pow(2.0, i / 2.0));
+        if (len >= maxlen) {
+            lens.push_back(maxlen);
+            break;
+        }
+        lens.push_back(len);
+    }
+
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+
+    if (format == SWEEP_TEXT) {
+        printf("[[[ Speed Sweep Tests ]]]\n\n");
+        PrintTimerInfo();
+        printf("Cache sizes        -");
+        if (caches.empty()) {
+            printf(" unknown");
+        }
+        for (size_t i = 0; i < caches.size(); i++) {
+            printf("%s L%u %" PRIu64 " KiB", (i == 0) ? "" : ",", caches[i].level, caches[i].size >> 10);
+        }
+        printf("\n\n");
+        printf("%12s  %5s  %11s  %13s  %12s  %15s\n", "Key bytes", "Cache", "bytes/cycle",
+                "cycles/hash", "ns/hash", "GB/sec");
+        printf("%12s  %5s  %11s  %13s  %12s  %15s\n", "------------", "-----", "-----------",
+                "-------------", "------------", "---------------");
+    } else if (format == SWEEP_CSV) {
+        printf("hash,key_bytes,cache,bytes_per_cycle,cycles_per_hash,ns_per_hash,gb_per_sec\n");
+    } else {
+        printf("{\n  \"hash\": \"%s\",\n  \"ghz\": %.3f,\n  \"caches\": [", hinfo->name, ghz);
+        for (size_t i = 0; i < caches.size(); i++) {
+            printf("%s{ \"level\": %u, \"bytes\": %" PRIu64 " }", (i == 0) ? " " : ", ",
+                    caches[i].level, caches[i].size);
+        }
+        printf(" ],\n  \"points\": [\n");
+    }
+
+    WarmUp(hash, seed, TINY_TRIALS, 32);
+
+    for (size_t i = 0; i < lens.size(); i++) {
+        const uint64_t len = lens[i];
+        int            trials;
+
+        if (len < 128) {
+            trials = TINY_TRIALS / slowdown;
+        } else {
+            trials = (int)std::min((uint64_t)BULK_TRIALS, SWEEP_BYTES / slowdown / (2 * len));
+        }
+        trials = std::max(trials, SWEEP_MIN_TRIALS);
+
+        const double cycles = SpeedTest(hash, seed, trials, (int)len, 0, 0, 0);
+        const double bpc    = (double)len / cycles;
+        const char * cache  = CacheRegime(caches, len);
+
+        if (format == SWEEP_TEXT) {
+            printf("%12" PRIu64 "  %5s  %11.3f  %13.2f  %12.2f  %15.3f\n", len, cache, bpc,
+                    cycles, cycles / ghz, bpc * ghz);
+        } else if (format == SWEEP_CSV) {
+            printf("%s,%" PRIu64 ",%s,%.4f,%.2f,%.2f,%.4f\n", hinfo->name, len, cache, bpc,
+                    cycles, cycles / ghz, bpc * ghz);
+        } else {
+            printf("    { \"key_bytes\": %" PRIu64 ", \"cache\": \"%s\", \"bytes_per_cycle\": %.4f, "
+                    "\"cycles_per_hash\": %.2f, \"ns_per_hash\": %.2f, \"gb_per_sec\": %.4f }%s\n",
+                    len, cache, bpc, cycles, cycles / ghz, bpc * ghz, (i + 1 < lens.size()) ? "," : "");
+        }
+    }
+
+    if (format == SWEEP_TEXT) {
+        printf("\n");
+    } else if (format == SWEEP_JSON) {
+        printf("  ]\n}\n");
+    }
+
+    fflush(NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Workload-driven speed test. Instead of uniform sizes, key lengths
+// are drawn from a histogram, either one of the built-in profiles
+// below or one read from a file, and the keys are hashed in a shuffled
+// stream. Hashes which dispatch on key length pay for branch
+// mispredictions here which the fixed-size tests never show, so each
+// stream is also timed with the same keys sorted by length.
+//
+// A histogram file has one bucket per line: a length (or an inclusive
+// range of lengths, like "9-24") and a relative weight. Lengths within
+// a bucket are equally likely. Blank lines and "#" comments are
+// ignored.
+
+struct WorkloadBucket {
+    uint32_t  minlen;
+    uint32_t  maxlen;
+    double    weight;
+};
+
+struct WorkloadProfile {
+    const char *                 name;
+    const char *                 desc;
+    std::vector<WorkloadBucket>  buckets;
+};
+
+static const WorkloadProfile workload_profiles[] = {
+    { "intid"  , "32- and 64-bit integer IDs",
+      { {  4,    4, 40 }, {   8,    8, 60 } } },
+    { "uuid"   , "UUIDs, as binary and as text",
+      { { 16,   16, 50 }, {  36,   36, 50 } } },
+    { "url"    , "URLs",
+      { { 16,   31, 10 }, {  32,   63, 40 }, {  64,  127, 35 }, { 128, 255, 12 }, { 256, 2047, 3 } } },
+    { "logline", "log lines",
+      { { 32,   63,  5 }, {  64,  127, 30 }, { 128,  255, 45 }, { 256, 511, 15 }, { 512, 2047, 5 } } },
+    { "kv"     , "key-value store keys: mostly 8-24 bytes, with a long tail",
+      { {  1,    7,  5 }, {   8,   24, 70 }, {  25,   64, 15 }, {  65, 256,  7 }, { 257, 2048, 3 } } },
+};
+
+constexpr uint32_t WORKLOAD_MAX_LEN     = 65536;
+constexpr uint64_t WORKLOAD_STREAM_SIZE = 256 * 1024; // Bytes of keys per stream
+constexpr int      WORKLOAD_MIN_KEYS    = 1024;
+constexpr int      WORKLOAD_MAX_KEYS    = 16384;
+constexpr uint64_t WORKLOAD_BYTES       = UINT64_C(128) << 20;
+constexpr int      WORKLOAD_MIN_TRIALS  = 16;
+constexpr int      WORKLOAD_MAX_TRIALS  = 2000;
+
+static bool LoadWorkloadProfile( const char * filename, WorkloadProfile & profile ) {
+    FILE * f = fopen(filename, "r");
+    char   buf[256];
+    int    lineno = 0;
+
+    if (f == NULL) {
+        printf("Could not open key-length histogram \"%s\"\n", filename);
+        return false;
+    }
+    profile.name = filename;
+    profile.desc = "key-length histogram from file";
+    profile.buckets.clear();
+    while (fgets(buf, sizeof(buf), f) != NULL) {
+        WorkloadBucket bucket;
+        char           extra;
+        lineno++;
+        buf[strcspn(buf, "#\n")] = '\0';
+        if (buf[strspn(buf, " \t\r")] == '\0') {
+            continue;
+        }
+        if (sscanf(buf, "%u-%u %lf %c", &bucket.minlen, &bucket.maxlen, &bucket.weight, &extra) != 3) {
+            if (sscanf(buf, "%u %lf %c", &bucket.minlen, &bucket.weight, &extra) != 2) {
+                printf("Error parsing \"%s\" line %d\n", filename, lineno);
+                fclose(f);
+                return false;
+            }
+            bucket.maxlen = bucket.minlen;
+        }
+        if ((bucket.minlen > bucket.maxlen) || (bucket.maxlen > WORKLOAD_MAX_LEN) || !(bucket.weight >= 0.0)) {
+            printf("Invalid bucket in \"%s\" line %d\n", filename, lineno);
+            fclose(f);
+            return false;
+        }
+        profile.buckets.push_back(bucket);
+    }
+    fclose(f);
+
+    double total = 0.0;
+    for (const WorkloadBucket & bucket: profile.buckets) {
+        total += bucket.weight;
+    }
+    if (total <= 0.0) {
+        printf("Key-length histogram \"%s\" is empty\n", filename);
+        return false;
+    }
+
+    return true;
+}
+
+// Keys are packed back to back, in stream order.
+struct KeyStream {
+    std::vector<uint8_t>   data;
+    std::vector<uint32_t>  offsets;
+    std::vector<uint32_t>  lens;
+};
+
+static void MakeKeyStream( KeyStream & stream, const std::vector<uint32_t> & lens, Rand & r ) {
+    uint64_t total = 0;
+
+    for (uint32_t len: lens) {
+        total += len;
+    }
+    stream.data.resize(total + 1);
+    stream.offsets.clear();
+    stream.lens = lens;
+    r.rand_p(&stream.data[0], total + 1);
+    total = 0;
+    for (uint32_t len: lens) {
+        stream.offsets.push_back(total);
+        total += len;
+    }
+}
+
+NEVER_INLINE static int64_t timehash_stream( HashFn hash, const seed_t seed, const KeyStream & stream ) {
+    const uint8_t * const  data    = &stream.data[0];
+    const uint32_t * const offsets = &stream.offsets[0];
+    const uint32_t * const lens    = &stream.lens[0];
+    const size_t           count   = stream.lens.size();
+    volatile int64_t       begin, end;
+    uint32_t hash_temp[64] = { 0 };
+
+    begin = timer_start();
+
+    for (size_t i = 0; i < count; i++) {
+        hash(data + offsets[i], lens[i], seed, hash_temp);
+    }
+
+    end = timer_end();
+
+    return end - begin;
+}
+
+static void WorkloadSpeedTest( const HashInfo * hinfo, seed_t seed, const WorkloadProfile & profile ) {
+    const HashFn hash     = hinfo->hashFn(g_hashEndian);
+    const int    slowdown = hinfo->isVerySlow() ? 16 : (hinfo->isSlow() ? 4 : 1);
+    const double ghz      = GetTimerInfo().ticks_per_ns;
+    Rand         r( 461402 );
+
+    // Pick the number of keys so the stream stays about the size of
+    // the bulk test's buffer.
+    double totalweight = 0.0, meanlen = 0.0;
+    for (const WorkloadBucket & bucket: profile.buckets) {
+        totalweight += bucket.weight;
+        meanlen     += bucket.weight * (bucket.minlen + bucket.maxlen) / 2.0;
+    }
+    meanlen /= totalweight;
+    const int nkeys = std::min(std::max((int)(WORKLOAD_STREAM_SIZE / std::max(meanlen, 1.0)),
+            WORKLOAD_MIN_KEYS), WORKLOAD_MAX_KEYS);
+
+    // Each bucket gets its share of keys exactly, by largest remainder
+    std::vector<int>    counts( profile.buckets.size() );
+    std::vector<double> remainders( profile.buckets.size() );
+    int assigned = 0;
+    for (size_t i = 0; i < profile.buckets.size(); i++) {
+        double share = nkeys * profile.buckets[i].weight / totalweight;
+        counts[i]     = (int)share;
+        remainders[i] = share - counts[i];
+        assigned     += counts[i];
+    }
+    while (assigned < nkeys) {
+        size_t best = std::max_element(remainders.begin(), remainders.end()) - remainders.begin();
+        counts[best]++;
+        remainders[best] = -1.0;
+        assigned++;
+    }
+
+    std::vector<uint32_t> lens;
+    uint64_t bytes = 0;
+    for (size_t i = 0; i < profile.buckets.size(); i++) {
+        const WorkloadBucket & bucket = profile.buckets[i];
+        for (int j = 0; j < counts[i]; j++) {
+            uint32_t len = bucket.minlen + r.rand_range(bucket.maxlen - bucket.minlen + 1);
+            lens.push_back(len);
+            bytes += len;
+        }
+    }
+    for (size_t i = lens.size() - 1; i > 0; i--) {
+        std::swap(lens[i], lens[r.rand_range(i + 1)]);
+    }
+
+    KeyStream shuffled, sorted;
+    MakeKeyStream(shuffled, lens, r);
+    std::sort(lens.begin(), lens.end());
+    MakeKeyStream(sorted  , lens, r);
+
+    const uint32_t minlen = lens.front();
+    const uint32_t maxlen = lens.back();
+    int trials = (int)(WORKLOAD_BYTES / slowdown / std::max(bytes, (uint64_t)1));
+    trials = std::min(std::max(trials, WORKLOAD_MIN_TRIALS), WORKLOAD_MAX_TRIALS);
+
+    printf("Workload '%s' - %s\n", profile.name, profile.desc);
+    printf("  %d keys, %.1f bytes mean length, [%u, %u]-byte keys\n", nkeys,
+            (double)bytes / nkeys, minlen, maxlen);
+
+    // Warm up, then alternate between the streams so they see the
+    // same machine conditions.
+    const double overhead = GetTimerInfo().overhead;
+    std::vector<double> shuffledtimes, sortedtimes;
+    volatile int64_t warmup = timehash_stream(hash, seed, shuffled);
+    warmup = timehash_stream(hash, seed, sorted);
+    for (int i = 0; i < trials; i++) {
+        shuffledtimes.push_back(std::max((double)timehash_stream(hash, seed, shuffled) - overhead, 0.0) / nkeys);
+        sortedtimes.push_back(std::max((double)timehash_stream(hash, seed, sorted) - overhead, 0.0) / nkeys);
+    }
+
+    double cycles[2], stdv[2];
+    std::vector<double> * timevecs[2] = { &shuffledtimes, &sortedtimes };
+    for (int i = 0; i < 2; i++) {
+        std::vector<double> & timevec = *timevecs[i];
+        std::sort(timevec.begin(), timevec.end());
+        FilterOutliers(timevec);
+        cycles[i] = CalcMean(timevec, 0, timevec.size() / 2);
+        stdv[i]   = CalcStdv(timevec);
+    }
+
+    const char * labels[2] = { "shuffled lengths", "sorted lengths  " };
+    for (int i = 0; i < 2; i++) {
+        const double ns = cycles[i] / ghz;
+        printf("  %s - %8.2f cycles/hash %8.2f ns - %8.3f Mhash/sec - %7.3f GB/sec (%8.4f%% stdv)\n",
+                labels[i], cycles[i], ns, 1000.0 / ns, (double)bytes / nkeys / ns, 100.0 * stdv[i] / cycles[i]);
+    }
+    printf("  Unpredictable lengths cost %+.1f%%\n\n", 100.0 * (cycles[0] / cycles[1] - 1.0));
+
+    SpeedBaselineRecord(hinfo->name, std::string("Workload/") + profile.name, cycles[0], stdv[0]);
+}
+
+// workload is a profile name or a histogram filename. If it is NULL,
+// every built-in profile is run.
+void SpeedWorkloadTest( const HashInfo * hinfo, const char * workload ) {
+    Rand r( 513298 );
+
+    printf("[[[ Speed Workload Tests ]]]\n\n");
+
+    std::vector<WorkloadProfile> profiles;
+    for (const WorkloadProfile & profile: workload_profiles) {
+        if ((workload == NULL) || (strcmp(workload, profile.name) == 0)) {
+            profiles.push_back(profile);
+        }
+    }
+    if (profiles.empty()) {
+        WorkloadProfile profile;
+        if (!LoadWorkloadProfile(workload, profile)) {
+            printf("Skipping workload speed test\n\n");
+            return;
+        }
+        profiles.push_back(profile);
+    }
+
+    PrintTimerInfo();
+
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+
+    for (const WorkloadProfile & profile: profiles) {
+        WorkloadSpeedTest(hinfo, seed, profile);
+    }
+
+    fflush(NULL);
+}
+
+//-----------------------------------------------------------------------------
+// Cold-cache speed test. The other speed tests hash keys which are
+// already in cache, with the hash's own state (like lookup tables)
+// also in cache. Here, each key is at a random place in an arena much
+// larger than the last-level cache, so reading it usually misses in
+// both the caches and the TLB. A second variant also sweeps through a
+// buffer twice the size of the largest private cache before each
+// hash, which evicts the hash's lookup tables from L1 and L2. That
+// evicts its code and stack too, so a hash without tables still slows
+// down somewhat; compare against one of those to see the tables' cost.
+//
+// Each call is timed on its own, since a batch would let the CPU
+// overlap the misses. Medians are reported, rather than the means of
+// the fastest timings, because the slow calls are the point here.
+
+constexpr uint64_t COLD_MIN_ARENA = UINT64_C(256) << 20;
+constexpr uint64_t COLD_MAX_ARENA = UINT64_C(1)   << 30;
+constexpr uint64_t COLD_EVICT     = UINT64_C(4)   << 20; // If cache sizes are unknown
+constexpr int      COLD_CALLS     = 2048;
+
+static const int cold_sizes[] = { 16, 64, 256, 4096 };
+
+NEVER_INLINE static int64_t timehash_one( HashFn hash, const seed_t seed, const uint8_t * key, int len ) {
+    volatile int64_t begin, end;
+    uint32_t         hash_temp[64];
+
+    begin = timer_start();
+
+    hash(key, len, seed, hash_temp);
+
+    end = timer_end();
+
+    return end - begin;
+}
+
+static void EvictCaches( const std::vector<uint8_t> & evict ) {
+    static volatile uint8_t sink;
+    uint8_t sum = 0;
+
+    for (size_t i = 0; i < evict.size(); i += 64) {
+        sum += evict[i];
+    }
+    sink = sum;
+}
+
+static double ColdSpeedTest( HashFn hash, seed_t seed, const uint8_t * arena, uint64_t arenasize,
+        int len, const std::vector<uint8_t> * evict, Rand & r ) {
+    const double        overhead = GetTimerInfo().overhead;
+    std::vector<double> times( COLD_CALLS );
+
+    for (int i = 0; i < COLD_CALLS; i++) {
+        const uint8_t * key = arena + (r.rand_u64() % (arenasize - len));
+        if (evict != NULL) {
+            EvictCaches(*evict);
+        }
+        times[i] = std::max((double)timehash_one(hash, seed, key, len) - overhead, 0.0);
+    }
+
+    return CalcMedian(times);
+}
+
+void SpeedColdTest( const HashInfo * hinfo ) {
+    const HashFn hash     = hinfo->hashFn(g_hashEndian);
+    const double ghz      = GetTimerInfo().ticks_per_ns;
+    Rand         r( 270833 );
+
+    printf("[[[ Speed Cold-Cache Tests ]]]\n\n");
+    PrintTimerInfo();
+
+    const std::vector<CacheLevel> caches = GetDataCaches();
+    uint64_t arenasize = caches.empty() ? COLD_MIN_ARENA : 2 * caches.back().size;
+    arenasize = std::min(std::max(arenasize, COLD_MIN_ARENA), COLD_MAX_ARENA);
+    uint64_t evictsize = (caches.size() < 2) ? COLD_EVICT : 2 * caches[caches.size() - 2].size;
+
+    // This deliberately doesn't use huge pages, even with --hugepages,
+    // since TLB misses are part of what is being measured.
+    uint8_t * arena = new (std::nothrow) uint8_t[arenasize];
+    if (arena == NULL) {
+        printf("Could not allocate a %" PRIu64 " MiB arena; skipping cold-cache test\n\n", arenasize >> 20);
+        return;
+    }
+    // Every page must really be written, or they could all share the
+    // kernel's zero page.
+    r.rand_p(arena, arenasize);
+    std::vector<uint8_t> evict( evictsize, 1 );
+
+    printf("Keys are scattered over a %" PRIu64 " MiB arena; L1 and L2 are flushed with a %" PRIu64
+            " KiB sweep\n\n", arenasize >> 20, evictsize >> 10);
+    printf("%9s  %21s  %21s  %21s\n", "Key bytes", "Hot cycles/hash  ", "Cold keys        ",
+            "Cold keys, L2 flushed");
+    printf("%9s  %21s  %21s  %21s\n", "---------", "---------------------", "---------------------",
+            "---------------------");
+
+    const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
+    WarmUp(hash, seed, TINY_TRIALS, 32);
+
+    for (int len: cold_sizes) {
+        const double hot       = SpeedTest(hash, seed, (len < 128) ? TINY_TRIALS : BULK_TRIALS / 16, len, 0, 0, 0);
+        const double coldkeys  = ColdSpeedTest(hash, seed, arena, arenasize, len, NULL  , r);
+        const double coldboth  = ColdSpeedTest(hash, seed, arena, arenasize, len, &evict, r);
+
+        printf("%9d  %10.2f %8.2f ns  %10.2f %8.2f ns  %10.2f %8.2f ns\n", len, hot, hot / ghz,
+                coldkeys, coldkeys / ghz, coldboth, coldboth / ghz);
+    }
+    printf("\n");
+
+    delete [] arena;
+    fflush(NULL);
+}
+
+//-----------------------------------------------------------------------------
+// A/B speed comparison. Hash A is timed against either hash B, with
+// their timings interleaved so that drift in machine state affects both
+// equally, or against samples saved by an earlier run (e.g. a previous
+// build of hash A).
+//
+// Each sample is one short SpeedTest() run, and each key size gets
+// COMPARE_ROUNDS samples per hash. The reported delta is the ratio of
+// the median samples, with a bootstrap confidence interval, and a
+// Mann-Whitney U test decides whether the difference is significant.
+
+constexpr int      COMPARE_ROUNDS       = 24;
+constexpr int      COMPARE_TINY_TRIALS  = 24;
+constexpr uint64_t COMPARE_SAMPLE_BYTES = UINT64_C(4) << 20;
+constexpr unsigned COMPARE_RESAMPLES    = 2000;
+constexpr double   COMPARE_LEVEL        = 0.95;
+constexpr double   COMPARE_ALPHA        = 0.01;
+
+static const int compare_sizes[] = { 4, 8, 16, 32, 64, 256, 1024, 4096, 16384, 262144 };
+
+typedef std::map<int, std::vector<double>> SpeedSamples;
+
+static double SpeedSample( const HashInfo * hinfo, seed_t seed, int len ) {
+    const HashFn hash     = hinfo->hashFn(g_hashEndian);
+    const int    slowdown = hinfo->isVerySlow() ? 16 : (hinfo->isSlow() ? 4 : 1);
+    int          trials;
+
+    if (len < 128) {
+        trials = COMPARE_TINY_TRIALS;
+    } else {
+        trials = (int)std::min((uint64_t)BULK_TRIALS, COMPARE_SAMPLE_BYTES / slowdown / (2 * len));
+        trials = std::max(trials, SWEEP_MIN_TRIALS);
+    }
+
+    return SpeedTest(hash, hinfo->Seed(seed), trials, len, 0, 0, 0);
+}
+
+static bool SaveSpeedSamples( const char * filename, const HashInfo * hinfo, const SpeedSamples & samples ) {
+    FILE * f = fopen(filename, "w");
+
+    if (f == NULL) {
+        return false;
+    }
+    fprintf(f, "SMHasher3-speed-samples 1\n");
+    fprintf(f, "hash %s\n", hinfo->name);
+    for (const auto & s: samples) {
+        fprintf(f, "%d %zu", s.first, s.second.size());
+        for (double t: s.second) {
+            fprintf(f, " %.4f", t);
+        }
+        fprintf(f, "\n");
+    }
+
+    return fclose(f) == 0;
+}
+
+static bool LoadSpeedSamples( const char * filename, std::string & name, SpeedSamples & samples ) {
+    FILE * f = fopen(filename, "r");
+    char   buf[256];
+    int    version;
+    bool   ok;
+
+    if (f == NULL) {
+        return false;
+    }
+    ok = (fscanf(f, "SMHasher3-speed-samples %d hash %255s", &version, buf) == 2) && (version == 1);
+    if (ok) {
+        int    len;
+        size_t count;
+        name = buf;
+        while (fscanf(f, "%d %zu", &len, &count) == 2) {
+            std::vector<double> & v = samples[len];
+            v.resize(count);
+            for (size_t i = 0; ok && (i < count); i++) {
+                ok = (fscanf(f, "%lf", &v[i]) == 1);
+            }
+        }
+        ok = ok && feof(f);
+    }
+    fclose(f);
+
+    return ok;
+}
+
+// other may be NULL, in which case B's samples come from loadfile (if
+// given). Samples saved from a different hash are refused unless
+// anyname is set. Hash A's samples are written to savefile, if given.
+bool SpeedCompareTest( const HashInfo * hinfo, const HashInfo * other, const char * loadfile,
+        const char * savefile, bool anyname ) {
+    Rand         r( 958201 );
+    SpeedSamples samplesA, samplesB;
+    std::string  nameB;
+    bool         result = true;
+
+    printf("[[[ Speed Comparison Tests ]]]\n\n");
+
+    if (other != NULL) {
+        nameB = other->name;
+    } else if (loadfile != NULL) {
+        if (!LoadSpeedSamples(loadfile, nameB, samplesB)) {
+            printf("Could not read speed samples from \"%s\"; skipping comparison\n\n", loadfile);
+            return false;
+        }
+        if (nameB != hinfo->name) {
+            if (!anyname) {
+                printf("Speed samples in \"%s\" are for %s, not %s; skipping comparison\n"
+                        "(use --compare-any-hash to compare them anyway)\n\n", loadfile, nameB.c_str(), hinfo->name);
+                return false;
+            }
+            printf("WARNING: comparing %s against saved samples for %s\n\n", hinfo->name, nameB.c_str());
+        }
+        nameB += std::string(" (from ") + loadfile + ")";
+    } else if (savefile == NULL) {
+        printf("Nothing to compare against; use --compare=<hashname|file>\n\n");
+        return false;
+    }
+
+    PrintTimerInfo();
+
+    const seed_t seedA = g_seed ^ r.rand_u64();
+    const seed_t seedB = g_seed ^ r.rand_u64();
+
+    // Do a warmup to get things into cache
+    volatile double warmup_cycles = SpeedSample(hinfo, seedA, 32);
+    if (other != NULL) {
+        warmup_cycles = SpeedSample(other, seedB, 32);
+    }
+
+    // Alternate which hash goes first, so neither always runs on the
+    // heels of the other.
+    for (int round = 0; round < COMPARE_ROUNDS; round++) {
+        for (size_t i = 0; i < sizeof(compare_sizes) / sizeof(compare_sizes[0]); i++) {
+            const int len = compare_sizes[i];
+            if ((other != NULL) && ((round + i) & 1)) {
+                samplesB[len].push_back(SpeedSample(other, seedB, len));
+            }
+            samplesA[len].push_back(SpeedSample(hinfo, seedA, len));
+            if ((other != NULL) && !((round + i) & 1)) {
+                samplesB[len].push_back(SpeedSample(other, seedB, len));
+            }
+        }
+    }
+
+    if (savefile != NULL) {
+        if (SaveSpeedSamples(savefile, hinfo, samplesA)) {
+            printf("Saved speed samples for %s to \"%s\"\n\n", hinfo->name, savefile);
+        } else {
+            printf("WARNING: could not write speed samples to \"%s\"\n\n", savefile);
+            result = false;
+        }
+    }
+
+    if (nameB.empty()) {
+        return result;
+    }
+
+    printf("A: %s\nB: %s\n\n", hinfo->name, nameB.c_str());
+    printf("%9s  %12s  %12s  %8s  %21s  %9s  %s\n", "Key bytes", "A cyc/hash", "B cyc/hash",
+            "Delta", "95% CI of delta  ", "p-value", "Verdict");
+    printf("%9s  %12s  %12s  %8s  %21s  %9s  %s\n", "---------", "------------", "------------",
+            "--------", "---------------------", "---------", "-------");
+
+    int faster = 0, slower = 0, same = 0;
+    for (auto & s: samplesA) {
+        const int             len = s.first;
+        std::vector<double> & a   = s.second;
+        auto                  bi  = samplesB.find(len);
+
+        if ((bi == samplesB.end()) || bi->second.empty()) {
+            printf("%9d  %12.2f  %12s\n", len, CalcMedian(a), "-");
+            continue;
+        }
+
+        std::vector<double> & b = bi->second;
+        double lo, hi;
+        BootstrapMedianRatioCI(a, b, COMPARE_LEVEL, COMPARE_RESAMPLES, 318 + len, lo, hi);
+        const double p     = MannWhitneyPValue(a, b);
+        const double ratio = CalcMedian(b) / CalcMedian(a);
+
+        const char * verdict;
+        if ((p < COMPARE_ALPHA) && (lo > 1.0)) {
+            verdict = "B slower";
+            slower++;
+        } else if ((p < COMPARE_ALPHA) && (hi < 1.0)) {
+            verdict = "B faster";
+            faster++;
+        } else {
+            verdict = "no significant difference";
+            same++;
+        }
+
+        printf("%9d  %12.2f  %12.2f  %+7.2f%%  [%+7.2f%%, %+7.2f%%]  %9.2e  %s\n", len, CalcMedian(a),
+                CalcMedian(b), 100.0 * (ratio - 1.0), 100.0 * (lo - 1.0), 100.0 * (hi - 1.0), p, verdict);
+    }
+
+    printf("\nB is faster at %d, slower at %d, and indistinguishable at %d key sizes\n\n",
+            faster, slower, same);
+
+    return result;
+}
+
 //-----------------------------------------------------------------------------
 bool SpeedTest( const HashInfo * hinfo ) {
     bool result = true;
     Rand r( 633692 );
 
     printf("[[[ Speed Tests ]]]\n\n");
+    PrintTimerInfo();
 
     const seed_t seed = hinfo->Seed(g_seed ^ r.rand_u64());
 
@@ -348,19 +1221,26 @@ bool SpeedTest( const HashInfo * hinfo ) {
 // Does 5 different speed tests to try to summarize hash performance
 
 void ShortSpeedTestHeader( bool verbose ) {
-    printf("Bulk results are in bytes/cycle, short results are in cycles/hash\n\n");
+    PrintTimerInfo();
+    printf("Bulk results are in bytes/cycle, short results are in cycles/hash\n");
+    printf("Short results are latency (each key depends on the previous hash), then\n"
+           "throughput (independent keys)\n");
+    printf("Reseed results are in cycles per Seed() call\n\n");
     if (verbose) {
-        printf("%-25s  %10s  %9s  %17s  %17s  %17s  %17s  \n",
-                "Name", "Impl   ", "Bulk  ", "1-8 bytes    ", "9-16 bytes   ", "17-24 bytes   ", "25-32 bytes   ");
-        printf("%-25s  %-10s  %9s  %17s  %17s  %17s  %17s  \n",
-                "-------------------------", "----------", "---------", "-----------------",
-                "-----------------", "-----------------", "-----------------");
+        printf("%-25s  %-10s  %9s  %23s  %23s  %23s  %23s  %9s\n",
+                "Name", "Impl   ", "Bulk  ", "1-8 bytes        ", "9-16 bytes        ",
+                "17-24 bytes        ", "25-32 bytes        ", "Reseed ");
+        printf("%-25s  %-10s  %9s  %23s  %23s  %23s  %23s  %9s\n",
+                "-------------------------", "----------", "---------", "-----------------------",
+                "-----------------------", "-----------------------", "-----------------------",
+                "---------");
     } else {
-        printf("%-25s  %9s  %11s  %11s  %11s  %11s  \n",
-                "Name", "Bulk  ", "1-8 bytes ", "9-16 bytes", "17-24 bytes", "25-32 bytes");
-        printf("%-25s  %9s  %11s  %11s  %11s  %11s  \n",
-                "-------------------------", "---------", "-----------",
-                "-----------", "-----------", "-----------");
+        printf("%-25s  %9s  %15s  %15s  %15s  %15s  %9s\n",
+                "Name", "Bulk  ", "1-8 bytes    ", "9-16 bytes    ", "17-24 bytes    ", "25-32 bytes    ",
+                "Reseed ");
+        printf("%-25s  %9s  %15s  %15s  %15s  %15s  %9s\n",
+                "-------------------------", "---------", "---------------",
+                "---------------", "---------------", "---------------", "---------");
     }
 }
 
@@ -383,23 +1263,26 @@ void ShortSpeedTest( const HashInfo * hinfo, bool verbose ) {
         const int baselen    = 256 * 1024;
         const int maxvarylen = 127;
 
-        // Do a warmup to get things into cache
-        volatile double warmup_cycles =
-                SpeedTest(hash, seed, BULK_TRIALS, baselen, 0, 0, 0);
+        // Warm up, to get things into cache and let the clock settle
+        WarmUp(hash, seed, BULK_TRIALS, baselen);
 
         // Do a bulk speed test, varying precise block size and alignment
         double cycles = SpeedTest(hash, seed, BULK_TRIALS, baselen, basealignoffset, maxvarylen, maxvaryalign);
         double curbpc = ((double)baselen - ((double)maxvarylen / 2)) / cycles;
-        printf("   %7.2f ", curbpc);
+        printf("  %9.2f", curbpc);
+        SpeedBaselineRecord(hinfo->name, "Short/bulk", cycles, stddev);
     }
 
     // Do 4 different small block speed tests, averaging over each
     // group of 8 byte lengths (1-8, 9-16, 17-24, 25-31), varying the
-    // alignment during each test.
+    // alignment during each test. Each is done in both latency and
+    // independent-key throughput modes.
     for (int i = 1; i <= 4; i++) {
         const int baselen     = i * 8;
         double    cycles      = 0.0;
+        double    indep       = 0.0;
         double    worstdevpct = 0.0;
+        double    worstindepdevpct = 0.0;
         for (int j = 0; j < 8; j++) {
             double curcyc = SpeedTest(hash, seed, TINY_TRIALS, baselen + j, basealignoffset, 0, maxvaryalign);
             double devpct = 100.0 * stddev / curcyc;
@@ -407,17 +1290,26 @@ void ShortSpeedTest( const HashInfo * hinfo, bool verbose ) {
             if (worstdevpct < devpct) {
                 worstdevpct = devpct;
             }
+            double curindep = SpeedTest(hash, seed, TINY_TRIALS, baselen + j, basealignoffset, 0, maxvaryalign, true);
+            double indepdevpct = 100.0 * stddev / curindep;
+            indep += curindep;
+            if (worstindepdevpct < indepdevpct) {
+                worstindepdevpct = indepdevpct;
+            }
         }
+        const std::string group = "Short/" + std::to_string(baselen - 7) + "-" + std::to_string(baselen);
+        SpeedBaselineRecord(hinfo->name, group           , cycles / 8.0, worstdevpct      / 100.0 * cycles / 8.0);
+        SpeedBaselineRecord(hinfo->name, group + "/indep", indep  / 8.0, worstindepdevpct / 100.0 * indep  / 8.0);
         if (verbose) {
             if (worstdevpct < 1.0) {
-                printf("   %7.2f [%5.3f] ", cycles / 8.0, worstdevpct);
+                printf("  %7.2f [%5.3f] %7.2f", cycles / 8.0, worstdevpct, indep / 8.0);
             } else {
-                printf("   %7.2f [%#.4g] ", cycles / 8.0, worstdevpct);
+                printf("  %7.2f [%#.4g] %7.2f", cycles / 8.0, worstdevpct, indep / 8.0);
             }
         } else {
-            printf("    %7.2f  ", cycles / 8.0);
+            printf("  %7.2f %7.2f", cycles / 8.0, indep / 8.0);
         }
     }
 
-    printf("\n");
+    printf("  %9.2f\n", ReseedCycles(hinfo));
 }
@@ -47,3 +47,17 @@
 bool SpeedTest( const HashInfo * info );
 void ShortSpeedTest( const HashInfo * hinfo, bool verbose );
 void ShortSpeedTestHeader( bool verbose );
+
+enum SpeedSweepFormat {
+    SWEEP_TEXT,
+    SWEEP_CSV,
+    SWEEP_JSON
+};
+void SpeedSweepTest( const HashInfo * hinfo, uint64_t maxlen, SpeedSweepFormat format );
+
+bool SpeedCompareTest( const HashInfo * hinfo, const HashInfo * other, const char * loadfile,
+        const char * savefile, bool anyname );
+
+void SpeedWorkloadTest( const HashInfo * hinfo, const char * workload );
+
+void SpeedColdTest( const HashInfo * hinfo );
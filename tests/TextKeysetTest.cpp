@@ -88,7 +88,7 @@ static bool TextKeyImpl( HashFn hash, const seed_t seed, const char * prefix, co
 
     //----------
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     hashes.resize(keycount);
 
     for (int i = 0; i < (int)keycount; i++) {
@@ -129,7 +129,7 @@ static bool WordsKeyImpl( HashFn hash, const seed_t seed, const long keycount, c
     assert(maxlen > minlen);
 
     std::unordered_set<std::string> words; // need to be unique, otherwise we report collisions
-    std::vector<hashtype>           hashes;
+    hugevector<hashtype>            hashes;
     hashes.resize(keycount);
     Rand r( 483723 + 2944 * minlen + maxlen );
 
@@ -188,7 +188,7 @@ static bool WordsLongImpl( HashFn hash, const seed_t seed, const long keycount,
     assert(minlen >= 0    );
     assert(maxlen > minlen);
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     hashes.resize(totalkeys);
     Rand r( 425379 + 94 * varyprefix + 604 * minlen + maxlen );
     size_t cnt = 0;
@@ -240,7 +240,7 @@ static bool WordsDictImpl( HashFn hash, const seed_t seed, bool verbose ) {
     printf("Keyset 'Dict' - dictionary words - %ld keys\n", wordscount);
 
     std::unordered_set<std::string> wordset; // need to be unique, otherwise we report collisions
-    std::vector<hashtype>           hashes;
+    hugevector<hashtype>            hashes;
     hashes.resize(wordscount);
 
     for (int i = 0; i < (int)wordscount; i++) {
@@ -62,7 +62,7 @@
 static constexpr int MAX_TWOBYTES = 56;
 
 template <typename hashtype>
-static void TwoBytesLenKeygen( HashFn hash, const seed_t seed, int keylen, std::vector<hashtype> & hashes ) {
+static void TwoBytesLenKeygen( HashFn hash, const seed_t seed, int keylen, hugevector<hashtype> & hashes ) {
     //----------
     // Compute # of keys
     int keycount = 0;
@@ -122,7 +122,7 @@ static void TwoBytesLenKeygen( HashFn hash, const seed_t seed, int keylen, std::
 
 template <typename hashtype>
 static bool TwoBytesTestLen( HashFn hash, const seed_t seed, int keylen, bool verbose, const bool extra ) {
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     TwoBytesLenKeygen(hash, seed, keylen, hashes);
 
@@ -140,7 +140,7 @@ static bool TwoBytesTestLen( HashFn hash, const seed_t seed, int keylen, bool ve
 // Keyset 'TwoBytesUpToLen' - generate all keys up to length N with one or two non-zero bytes
 
 template <typename hashtype>
-static void TwoBytesUpToLenKeygen( HashFn hash, const seed_t seed, int maxlen, std::vector<hashtype> & hashes ) {
+static void TwoBytesUpToLenKeygen( HashFn hash, const seed_t seed, int maxlen, hugevector<hashtype> & hashes ) {
     //----------
     // Compute # of keys
     int keycount = 0;
@@ -198,7 +198,7 @@ static void TwoBytesUpToLenKeygen( HashFn hash, const seed_t seed, int maxlen, s
 
 template <typename hashtype>
 static bool TwoBytesTestUpToLen( HashFn hash, const seed_t seed, int maxlen, bool verbose, const bool extra ) {
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     TwoBytesUpToLenKeygen(hash, seed, maxlen, hashes);
 
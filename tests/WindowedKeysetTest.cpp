@@ -80,7 +80,7 @@ static bool WindowedKeyImpl( HashFn hash, const seed_t seed, int windowbits, boo
         // fflush (NULL);
     }
 
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
     hashes.resize(keycount);
 
     bool result    = true;
@@ -71,7 +71,7 @@ static bool ZeroKeyImpl( HashFn hash, const seed_t seed, bool verbose ) {
     addVCodeInput(nullblock, keycount);
 
     //----------
-    std::vector<hashtype> hashes;
+    hugevector<hashtype> hashes;
 
     hashes.resize(keycount);
 
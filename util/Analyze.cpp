@@ -291,7 +291,7 @@ static bool ReportCollisions( uint64_t const nbH, int collcount, unsigned hashsi
 // Sort the hash list, count the total number of collisions and return
 // the first N collisions for further processing
 template <typename hashtype>
-unsigned int FindCollisions( std::vector<hashtype> & hashes, std::set<hashtype> & collisions,
+unsigned int FindCollisions( hugevector<hashtype> & hashes, std::set<hashtype> & collisions,
         int maxCollisions, bool drawDiagram ) {
     unsigned int collcount = 0;
 
@@ -353,29 +353,28 @@ INSTANTIATE(PrintCollisions, HASHTYPELIST);
 // since a collision for N bits is also a collision for N-k bits.
 //
 // This requires the vector of hashes to be sorted.
-template <typename hashtype>
-static void CountRangedNbCollisions( std::vector<hashtype> & hashes, uint64_t const nbH,
-        int minHBits, int maxHBits, int threshHBits, int * collcounts ) {
-    const int origBits = sizeof(hashtype) * 8;
-
-    assert(minHBits >= 1       );
-    assert(minHBits <= maxHBits);
-    assert(origBits >= maxHBits);
-    assert((threshHBits == 0) || (threshHBits >= minHBits));
-    assert((threshHBits == 0) || (threshHBits <= maxHBits));
-
-    const int collbins    = maxHBits - minHBits + 1;
-    const int maxcollbins = (threshHBits == 0) ? 0 : threshHBits - minHBits + 1;
-    int       prevcoll[maxcollbins + 1];
-    int       maxcoll[maxcollbins + 1];
-
-    memset(collcounts, 0, sizeof(collcounts[0]) * collbins );
-    memset(prevcoll  , 0, sizeof(prevcoll[0]) * maxcollbins);
-    memset(maxcoll   , 0, sizeof(maxcoll[0]) * maxcollbins );
+//
+// The counting is done by RangedNbCollisionCounter, which is given
+// the number of high bits each pair of adjacent sorted hashes has in
+// common, so that it can also be used without a sorted list of hashes;
+// see PrefixCountCollisions() below.
+class RangedNbCollisionCounter {
+  public:
+    RangedNbCollisionCounter( int minHBits, int maxHBits, int threshHBits, int * collcounts ) :
+        minHBits( minHBits ), maxHBits( maxHBits ), threshHBits( threshHBits ),
+        collbins( maxHBits - minHBits + 1 ), maxcollbins( (threshHBits == 0) ? 0 : threshHBits - minHBits + 1 ),
+        prevcoll( maxcollbins + 1, 0 ), maxcoll( maxcollbins + 1, 0 ), collcounts( collcounts ) {
+        assert(minHBits >= 1       );
+        assert(minHBits <= maxHBits);
+        assert((threshHBits == 0) || (threshHBits >= minHBits));
+        assert((threshHBits == 0) || (threshHBits <= maxHBits));
+
+        memset(collcounts, 0, sizeof(collcounts[0]) * collbins);
+    }
 
-    for (uint64_t hnb = 1; hnb < nbH; hnb++) {
-        hashtype hdiff = hashes[hnb - 1] ^ hashes[hnb];
-        int      hzb   = hdiff.highzerobits();
+    // hzb is the number of high zero bits in the XOR of the next pair
+    // of adjacent sorted hashes.
+    FORCE_INLINE void add( int hzb ) {
         if (hzb > maxHBits) {
             hzb = maxHBits;
         }
@@ -386,7 +385,7 @@ static void CountRangedNbCollisions( std::vector<hashtype> & hashes, uint64_t co
         // hash is a collision for *all* bit widths where we do care about
         // maximums, then this is all that need be done for this hash.
         if (hzb >= threshHBits) {
-            continue;
+            return;
         }
         // If we do care about maximum collision counts, then any window
         // sizes which are strictly larger than hzb have just encountered
@@ -413,12 +412,132 @@ static void CountRangedNbCollisions( std::vector<hashtype> & hashes, uint64_t co
         }
     }
 
-    for (int i = collbins - 2; i >= 0; i--) {
-        collcounts[i] += collcounts[i + 1];
+    void finish( void ) {
+        for (int i = collbins - 2; i >= 0; i--) {
+            collcounts[i] += collcounts[i + 1];
+        }
+        for (int i = maxcollbins - 1; i >= 0; i--) {
+            collcounts[i] = std::max(maxcoll[i], collcounts[i] - prevcoll[i]);
+        }
+    }
+
+  private:
+    const int         minHBits, maxHBits, threshHBits;
+    const int         collbins, maxcollbins;
+    std::vector<int>  prevcoll;
+    std::vector<int>  maxcoll;
+    int *             collcounts;
+};
+
+template <typename hashtype>
+static void CountRangedNbCollisions( hugevector<hashtype> & hashes, uint64_t const nbH,
+        int minHBits, int maxHBits, int threshHBits, int * collcounts ) {
+    const int origBits = sizeof(hashtype) * 8;
+
+    assert(origBits >= maxHBits);
+
+    RangedNbCollisionCounter counter( minHBits, maxHBits, threshHBits, collcounts );
+
+    for (uint64_t hnb = 1; hnb < nbH; hnb++) {
+        hashtype hdiff = hashes[hnb - 1] ^ hashes[hnb];
+        counter.add(hdiff.highzerobits());
+    }
+    counter.finish();
+}
+
+//-----------------------------------------------------------------------------
+// For wide hashes, sorting the list of hashes moves a lot of data, even
+// though almost every pair of adjacent sorted hashes differs in its top
+// 64 bits. So instead, this sorts a list of 96-bit items, each holding
+// the top 64 bits of a hash above the 32-bit index of that hash. Only
+// hashes which share their top 64 bits with another hash are then
+// gathered up and compared in full.
+//
+// This counts the same collisions as FindCollisions() does, and gives
+// counter the same values that CountRangedNbCollisions() would, in the
+// same order, but leaves the list of hashes unsorted. If reversed is
+// true, then every hash is treated as if its bits had been reversed,
+// for testing the low bits.
+//
+// The list of items counts as sorting scratch space, so this is only
+// used when blobsort() would be allowed that much, and the items are
+// then sorted with whatever is left of that budget, so that the two
+// together never exceed it.
+
+template <typename hashtype>
+static bool UsePrefixSort( uint64_t const nbH ) {
+    return (sizeof(hashtype) > sizeof(Blob<96>)) && (nbH <= UINT32_MAX) &&
+           ((nbH * sizeof(Blob<96>)) <= g_blobsortScratchMax);
+}
+
+template <typename hashtype>
+static FORCE_INLINE hashtype PrefixSortHash( const hashtype & hash, bool reversed ) {
+    hashtype h = hash;
+
+    if (reversed) {
+        h.reversebits();
+    }
+    return h;
+}
+
+template <typename hashtype>
+static unsigned int PrefixCountCollisions( const hugevector<hashtype> & hashes, bool reversed,
+        std::set<hashtype> * collisions, unsigned int maxCollisions, RangedNbCollisionCounter * counter ) {
+    const size_t           nbH = hashes.size();
+    hugevector<Blob<96>>   items;
+    std::vector<hashtype>  ties;
+    unsigned int           collcount = 0;
+
+    // Narrower hashes never get here, but must still compile.
+    const size_t plen = std::min(sizeof(hashtype), (size_t)8);
+    uint8_t      buf[12] = { 0 };
+
+    items.reserve(nbH);
+    for (size_t i = 0; i < nbH; i++) {
+        const hashtype h   = PrefixSortHash(hashes[i], reversed);
+        const uint32_t idx = COND_BSWAP((uint32_t)i, isBE());
+        memcpy(&buf[0], &idx, 4);
+        memcpy(&buf[12 - plen], &h[sizeof(hashtype) - plen], plen);
+        items.emplace_back(buf, sizeof(buf));
     }
-    for (int i = maxcollbins - 1; i >= 0; i--) {
-        collcounts[i] = std::max(maxcoll[i], collcounts[i] - prevcoll[i]);
+    blobsort(items.begin(), items.end(), g_NCPU, g_blobsortScratchMax - nbH * sizeof(Blob<96>));
+
+    size_t i = 0;
+    while (i < nbH) {
+        // Find the run of items sharing this item's prefix
+        size_t j = i + 1;
+        while ((j < nbH) && (memcmp(&items[j][4], &items[i][4], 8) == 0)) {
+            j++;
+        }
+        // This item's prefix differs from the last one's, so their
+        // XOR's high zero bits are all in the prefix.
+        if ((i > 0) && (counter != NULL)) {
+            counter->add((items[i - 1] ^ items[i]).highzerobits());
+        }
+        if ((j - i) > 1) {
+            ties.clear();
+            for (size_t k = i; k < j; k++) {
+                uint32_t idx;
+                memcpy(&idx, &items[k][0], 4);
+                ties.push_back(PrefixSortHash(hashes[COND_BSWAP(idx, isBE())], reversed));
+            }
+            blobsort(ties.begin(), ties.end());
+            for (size_t k = 1; k < ties.size(); k++) {
+                if (counter != NULL) {
+                    counter->add((ties[k - 1] ^ ties[k]).highzerobits());
+                }
+                if (ties[k] == ties[k - 1]) {
+                    collcount++;
+                    if ((collisions != NULL) && (collcount < maxCollisions)) {
+                        collisions->insert(ties[k]);
+                    }
+                }
+            }
+        }
+        i = j;
     }
+
+    return collcount;
 }
 
 //-----------------------------------------------------------------------------
@@ -535,7 +654,7 @@ static int MaxDistBits( const uint64_t nbH ) {
 }
 
 template <typename hashtype>
-static bool TestDistribution( std::vector<hashtype> & hashes, int * logpp, bool verbose, bool drawDiagram ) {
+static bool TestDistribution( hugevector<hashtype> & hashes, int * logpp, bool verbose, bool drawDiagram ) {
     const int      hashbits = sizeof(hashtype) * 8;
     const uint64_t nbH      = hashes.size();
     int            maxwidth = MaxDistBits(nbH);
@@ -721,7 +840,7 @@ static int FindMaxBits_TargetCollisionNb( uint64_t nbHashes, int minCollisions,
 // TestHashListWrapper in Analyze.h.
 
 template <typename hashtype>
-bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, int * logpSumPtr, bool drawDiagram,
+bool TestHashListImpl( hugevector<hashtype> & hashes, unsigned testDeltaNum, int * logpSumPtr, bool drawDiagram,
         bool testCollision, bool testMaxColl, bool testDist, bool testHighBits, bool testLowBits, bool verbose ) {
     uint64_t const nbH    = hashes.size();
     bool           result = true;
@@ -736,8 +855,8 @@ bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, in
     // This must be done before the list of hashes is sorted below via
     // FindCollisions(). The calls to test the list(s) of deltas come at
     // the bottom of this function.
-    std::vector<hashtype> hashdeltas_1;
-    std::vector<hashtype> hashdeltas_N;
+    hugevector<hashtype> hashdeltas_1;
+    hugevector<hashtype> hashdeltas_N;
 
     if (testDeltaNum >= 1) {
         hashdeltas_1.reserve(nbH);
@@ -766,8 +885,12 @@ bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, in
 
         addVCodeOutput(&hashes[0], sizeof(hashtype) * nbH);
 
+        // Wide hashes have their collisions counted along with their
+        // high-bits collisions below, without being sorted.
+        const bool prefixsort = UsePrefixSort<hashtype>(nbH);
+
         std::set<hashtype> collisions;
-        int collcount = FindCollisions(hashes, collisions, 1000, drawDiagram);
+        int collcount = prefixsort ? 0 : FindCollisions(hashes, collisions, 1000, drawDiagram);
 
         /*
          * Do all other compute-intensive stuff (as requested) before
@@ -850,7 +973,7 @@ bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, in
          */
         std::vector<int> collcounts_fwd;
         std::vector<int> collcounts_rev;
-        int minBits, maxBits, threshBits;
+        int minBits = 0, maxBits = 0, threshBits = 0;
 
         if (testHighBits || testLowBits) {
             std::set<int> combinedBitsvec;
@@ -859,13 +982,31 @@ bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, in
             ComputeCollBitBounds(combinedBitsvec, hashbits, nbH, minBits, maxBits, threshBits);
         }
 
-        if (testHighBits && (maxBits > 0)) {
-            collcounts_fwd.reserve(maxBits - minBits + 1);
+        if (prefixsort) {
+            std::set<hashtype> * collset = drawDiagram ? &collisions : NULL;
+            if (testHighBits && (maxBits > 0)) {
+                collcounts_fwd.resize(maxBits - minBits + 1);
+                RangedNbCollisionCounter counter( minBits, maxBits, threshBits, &collcounts_fwd[0] );
+                collcount = PrefixCountCollisions(hashes, false, collset, 1000, &counter);
+                counter.finish();
+            } else {
+                collcount = PrefixCountCollisions(hashes, false, collset, 1000, (RangedNbCollisionCounter *)NULL);
+            }
+            if (testLowBits && (maxBits > 0)) {
+                collcounts_rev.resize(maxBits - minBits + 1);
+                RangedNbCollisionCounter counter( minBits, maxBits, threshBits, &collcounts_rev[0] );
+                PrefixCountCollisions(hashes, true, (std::set<hashtype> *)NULL, 0, &counter);
+                counter.finish();
+            }
+        }
+
+        if (!prefixsort && testHighBits && (maxBits > 0)) {
+            collcounts_fwd.resize(maxBits - minBits + 1);
             CountRangedNbCollisions(hashes, nbH, minBits, maxBits, threshBits, &collcounts_fwd[0]);
         }
 
-        if (testLowBits && (maxBits > 0)) {
-            collcounts_rev.reserve(maxBits - minBits + 1);
+        if (!prefixsort && testLowBits && (maxBits > 0)) {
+            collcounts_rev.resize(maxBits - minBits + 1);
             for (size_t hnb = 0; hnb < nbH; hnb++) {
                 hashes[hnb].reversebits();
             }
@@ -980,7 +1121,7 @@ INSTANTIATE(TestHashListImpl, HASHTYPELIST);
 // pass the normal distribution test still work well in practice)
 
 template <typename hashtype>
-double TestDistributionBytepairs( std::vector<hashtype> & hashes, bool drawDiagram ) {
+double TestDistributionBytepairs( hugevector<hashtype> & hashes, bool drawDiagram ) {
     const int nbytes   = sizeof(hashtype);
     const int hashbits = nbytes * 8;
 
@@ -57,7 +57,7 @@ bool ReportChiSqIndep( const uint32_t * popcount, const uint32_t * andcount, siz
         size_t hashbits, size_t testcount, bool drawDiagram );
 
 template <typename hashtype>
-unsigned int FindCollisions( std::vector<hashtype> & hashes, std::set<hashtype> & collisions,
+unsigned int FindCollisions( hugevector<hashtype> & hashes, std::set<hashtype> & collisions,
         int maxCollisions = 1000, bool drawDiagram = false );
 
 template <typename hashtype>
@@ -66,7 +66,7 @@ void PrintCollisions( std::set<hashtype> & collisions );
 //-----------------------------------------------------------------------------
 // This is not intended to be used directly; see below
 template <typename hashtype>
-bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, int * logpSumPtr, bool drawDiagram,
+bool TestHashListImpl( hugevector<hashtype> & hashes, unsigned testDeltaNum, int * logpSumPtr, bool drawDiagram,
         bool testCollision, bool testMaxColl, bool testDist, bool testHighBits, bool testLowBits, bool verbose );
 
 // This provides a user-friendly wrapper to TestHashListImpl<>() by using
@@ -80,7 +80,7 @@ bool TestHashListImpl( std::vector<hashtype> & hashes, unsigned testDeltaNum, in
 template <typename hashtype>
 class TestHashListWrapper {
   private:
-    std::vector<hashtype> & hashes_;
+    hugevector<hashtype> & hashes_;
     unsigned  deltaNum_;
     int *     logpSumPtr_;
     bool      testCollisions_;
@@ -92,7 +92,7 @@ class TestHashListWrapper {
     bool      drawDiagram_;
 
   public:
-    inline TestHashListWrapper( std::vector<hashtype> & hashes ) :
+    inline TestHashListWrapper( hugevector<hashtype> & hashes ) :
         hashes_( hashes ), deltaNum_( 0 ), logpSumPtr_( NULL ),
         testCollisions_( true ), testMaxCollisions_( false ), testDistribution_( true ),
         testHighBits_( true ), testLowBits_( true ),
@@ -127,6 +127,6 @@ class TestHashListWrapper {
 }; // class TestHashListWrapper
 
 template <typename hashtype>
-TestHashListWrapper<hashtype> TestHashList( std::vector<hashtype> & hashes ) {
+TestHashListWrapper<hashtype> TestHashList( hugevector<hashtype> & hashes ) {
     return TestHashListWrapper<hashtype>(hashes);
 }
@@ -26,6 +26,10 @@
 #include <vector>
 #include <type_traits>
 
+// Out-of-place sorting of a list of 100M 256-bit hashes needs 3.2 GB of
+// scratch space, so larger lists are sorted in place by default.
+size_t g_blobsortScratchMax = (size_t)1 << 30;
+
 //-----------------------------------------------------------------------------
 // Blob sorting routine unit tests
 
@@ -232,14 +236,22 @@ static bool blobverify( std::vector<blobtype> & blobs ) {
     return passed;
 }
 
+// The self-test sizes are below PARALLEL_SORT_MIN, so when testing
+// with more than 1 thread, parallel_blobsort() is called directly, and
+// its results are also checked against std::sort(), to make sure no
+// items were lost or duplicated.
+//
+// If inplace is true, then blobsort() isn't allowed any scratch space.
 template <uint32_t TEST_SIZE, uint32_t TEST_ITER, typename blobtype>
-bool test_blobsort_type( void ) {
+bool test_blobsort_type( unsigned nthreads, bool inplace, size_t & timetotal ) {
     bool passed = true;
     std::vector<blobtype> blobs( TEST_SIZE );
-    size_t timetotal = 0;
+    std::vector<blobtype> expected;
     size_t timesum;
     std::vector<int> testnums;
 
+    timetotal = 0;
+
     if (TEST_ITER > 1) {
         testnums = { 4, 6, 8, 9, 10, 15, 16, 19 };
     } else {
@@ -252,21 +264,34 @@ bool test_blobsort_type( void ) {
         timesum = 0;
         for (int j = 0; j < TEST_ITER; j++) {
             blobfill<blobtype, TEST_SIZE>(blobs, i, j);
+            if ((TEST_ITER == 1) && (nthreads > 1)) {
+                expected = blobs;
+                std::sort(expected.begin(), expected.end());
+            }
             size_t timeBegin = monotonic_clock();
-            blobsort(blobs.begin(), blobs.end());
+            if ((TEST_ITER == 1) && (nthreads > 1)) {
+                parallel_blobsort(&blobs[0], &blobs[0] + TEST_SIZE, nthreads, inplace);
+            } else {
+                blobsort(blobs.begin(), blobs.end(), nthreads, inplace ? 0 : SIZE_MAX);
+            }
             size_t timeEnd   = monotonic_clock();
             timesum += timeEnd - timeBegin;
             passed  &= blobverify(blobs);
+            if ((TEST_ITER == 1) && (nthreads > 1)) {
+                passed &= (blobs == expected);
+            }
         }
         if (TEST_ITER > 1) {
             timetotal += timesum;
-            printf("%3lu bits, test %2d [%-50s]\t\t %5.2f s\n", sizeof(blobtype) * 8,
-                    i, teststr[i], (double)timesum / (double)NSEC_PER_SEC);
+            printf("%3lu bits, %2u thread%s, %-8s, test %2d [%-50s]\t %5.2f s\n", sizeof(blobtype) * 8,
+                    nthreads, (nthreads == 1) ? " " : "s", inplace ? "in-place" : "scratch", i, teststr[i],
+                    (double)timesum / (double)NSEC_PER_SEC);
         }
         // printf("After test %d: %s\n", i, passed ? "ok" : "no");
     }
     if (TEST_ITER > 1) {
-        printf("%3lu bits, %-60s\t\t%6.2f s\n\n", sizeof(blobtype) * 8, "SUM TOTAL",
+        printf("%3lu bits, %2u thread%s, %-8s, %-60s\t%6.2f s\n\n", sizeof(blobtype) * 8, nthreads,
+                (nthreads == 1) ? " " : "s", inplace ? "in-place" : "scratch", "SUM TOTAL",
                 (double)timetotal / (double)NSEC_PER_SEC);
     }
 
@@ -280,21 +305,47 @@ bool test_blobsort_type( void ) {
 // instantiations of test_blobsort_type<>. Then SortBenchmark() can just iterate over
 // those function pointers, calling each one in turn.
 
-typedef bool (* SortTestFn)( void );
+typedef bool (* SortTestFn)( unsigned nthreads, bool inplace, size_t & timetotal );
 
 template <uint32_t TEST_SIZE, uint32_t TEST_ITER, typename... T>
 std::vector<SortTestFn> PACKEXPANDER() {
     return { &test_blobsort_type<TEST_SIZE, TEST_ITER, T>... };
 }
 
-auto SortTestFns  = PACKEXPANDER<  100000,  1, HASHTYPELIST>();
-auto SortBenchFns = PACKEXPANDER<10000000, 10, HASHTYPELIST>();
+template <typename... T>
+std::vector<size_t> PACKBITS() {
+    return { sizeof(T) * 8 ... };
+}
+
+static const uint32_t SORT_BENCH_SIZE = 10000000;
+
+auto SortTestFns  = PACKEXPANDER<         100000,  1, HASHTYPELIST>();
+auto SortBenchFns = PACKEXPANDER<SORT_BENCH_SIZE, 10, HASHTYPELIST>();
+auto SortBits     = PACKBITS<HASHTYPELIST>();
+
+// Thread counts to benchmark: powers of 2 up to g_NCPU, and g_NCPU
+static std::vector<unsigned> SortThreadCounts( void ) {
+    std::vector<unsigned> counts;
+
+    for (unsigned n = 1; n < g_NCPU; n *= 2) {
+        counts.push_back(n);
+    }
+    counts.push_back(g_NCPU);
+
+    return counts;
+}
 
 void BlobsortTest( void ) {
-    bool result = true;
+    bool   result = true;
+    size_t timetotal;
 
     for (SortTestFn testFn: SortTestFns) {
-        result &= testFn();
+        for (bool inplace: { false, true }) {
+            result &= testFn(1, inplace, timetotal);
+#if defined(HAVE_THREADS)
+            result &= testFn(3, inplace, timetotal);
+#endif
+        }
     }
     if (!result) {
         printf("Blobsort self-test failed! Cannot continue\n");
@@ -304,12 +355,43 @@ void BlobsortTest( void ) {
     return;
 }
 
+// Each type is benchmarked with each thread count, both with a scratch
+// copy of the list and in place, and then the total times are
+// summarized, to show how well sorting scales and what sorting in
+// place costs.
 void BlobsortBenchmark( void ) {
+    const std::vector<unsigned> counts = SortThreadCounts();
+    std::vector<std::vector<size_t>> totals[2];
     bool result = true;
 
     for (SortTestFn testFn: SortBenchFns) {
-        result &= testFn();
+        for (int inplace = 0; inplace < 2; inplace++) {
+            totals[inplace].emplace_back(counts.size());
+            for (size_t i = 0; i < counts.size(); i++) {
+                result &= testFn(counts[i], inplace, totals[inplace].back()[i]);
+            }
+        }
     }
+
+    printf("Summary (total time, and speedup over 1 thread with scratch space)\n");
+    printf("%18s %12s", "", "max scratch");
+    for (size_t i = 0; i < counts.size(); i++) {
+        printf("%11u thread%s", counts[i], (counts[i] == 1) ? " " : "s");
+    }
+    printf("\n");
+    for (size_t type = 0; type < SortBits.size(); type++) {
+        for (int inplace = 0; inplace < 2; inplace++) {
+            const std::vector<size_t> & total = totals[inplace][type];
+            printf("%3zu bits, %-8s %8.1f MiB", SortBits[type], inplace ? "in-place" : "scratch",
+                    inplace ? 0.0 : (double)SORT_BENCH_SIZE * SortBits[type] / 8.0 / 1048576.0);
+            for (size_t i = 0; i < counts.size(); i++) {
+                printf("  %8.2f s %5.2fx", (double)total[i] / (double)NSEC_PER_SEC,
+                        (double)totals[0][type][0] / (double)total[i]);
+            }
+            printf("\n");
+        }
+    }
+
     if (!result) {
         printf("Blobsort self-test failed! Cannot continue\n");
         exit(1);
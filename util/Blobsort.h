@@ -17,6 +17,17 @@
  * <https://www.gnu.org/licenses/>.
  */
 
+// The most scratch space, in bytes, that blobsort() may allocate
+// before it falls back to sorting in place. This is set by
+// --sort-budget.
+extern size_t g_blobsortScratchMax;
+
+#if defined(HAVE_THREADS)
+  #include <vector>
+  #include <thread>
+  #include <atomic>
+#endif
+
 //-----------------------------------------------------------------------------
 // Blob sorting routines
 static const uint32_t RADIX_BITS = 8;
@@ -91,13 +102,48 @@ static void radixsort( T * begin, T * end ) {
 //-----------------------------------------------------------------------------
 static const uint32_t SORT_CUTOFF = 60;
 
+// Moves every item into the block for its byte at idx, given the
+// number of items in each block.
+template <typename T>
+static void flagpartition( T * begin, const size_t * freqs, int idx ) {
+    T * block_ptrs[RADIX_SIZE];
+    T * ptr = begin;
+    for (size_t i = 0; i < RADIX_SIZE; i++) {
+        block_ptrs[i] = ptr;
+        ptr += freqs[i];
+    }
+
+    // Move all values into their correct block, maintaining a stable
+    // sort ordering inside each block.
+    ptr = begin;
+    T *     nxt      = begin + freqs[0];
+    uint8_t curblock = 0;
+    while (curblock < (RADIX_SIZE - 1)) {
+        if (expectp((ptr >= nxt), 0.0944)) {
+            curblock++;
+            nxt += freqs[curblock];
+            continue;
+        }
+        uint8_t value = (*ptr)[idx];
+        if (unpredictable(value == curblock)) { // p ~= 0.501155
+            ptr++;
+            continue;
+        }
+        // assert(block_ptrs[value] < end);
+        std::swap(*ptr, *block_ptrs[value]++); // MAYBE do this better manually?
+    }
+}
+
 // This is an in-place MSB radix sort that recursively sorts each
 // block, sometimes known as an "American Flag Sort". Testing shows
 // that performance increases by devolving to std::sort once we get
 // down to small block sizes. Both 40 and 60 items are best on my
 // system, but there could be a better value for the general case.
+//
+// If inplace is false, then degenerate blocks are handed to
+// radixsort(), which needs scratch space as large as the block.
 template <typename T>
-static void flagsort( T * begin, T * end, int idx ) {
+static void flagsort( T * begin, T * end, int idx, bool inplace = false ) {
     const uint32_t DIGITS = sizeof(T);
     const size_t   count  = end - begin;
 
@@ -116,41 +162,19 @@ static void flagsort( T * begin, T * end, int idx ) {
     // there's no need to iterate over every item. Since this case is
     // only likely to hit in degenerate cases (e.g. donothing64), just
     // devolve into radixsort since that performs better on lists of
-    // many similar values.
+    // many similar values, unless no scratch space may be used.
     if (++freqs[(*ptr)[idx]] == count) {
         // If there are no more passes, then we're just done.
         if (idx == 0) {
             return;
         }
+        if (inplace) {
+            return flagsort(begin, end, idx - 1, inplace);
+        }
         return radixsort(begin, end);
     }
 
-    T * block_ptrs[RADIX_SIZE];
-    ptr = begin;
-    for (size_t i = 0; i < RADIX_SIZE; i++) {
-        block_ptrs[i] = ptr;
-        ptr += freqs[i];
-    }
-
-    // Move all values into their correct block, maintaining a stable
-    // sort ordering inside each block.
-    ptr = begin;
-    T *     nxt      = begin + freqs[0];
-    uint8_t curblock = 0;
-    while (curblock < (RADIX_SIZE - 1)) {
-        if (expectp((ptr >= nxt), 0.0944)) {
-            curblock++;
-            nxt += freqs[curblock];
-            continue;
-        }
-        uint8_t value = (*ptr)[idx];
-        if (unpredictable(value == curblock)) { // p ~= 0.501155
-            ptr++;
-            continue;
-        }
-        // assert(block_ptrs[value] < end);
-        std::swap(*ptr, *block_ptrs[value]++); // MAYBE do this better manually?
-    }
+    flagpartition(begin, freqs, idx);
 
     if (idx == 0) {
         return;
@@ -161,7 +185,7 @@ static void flagsort( T * begin, T * end, int idx ) {
     ptr = begin;
     for (int i = 0; i < RADIX_SIZE; i++) {
         if (expectp((freqs[i] > SORT_CUTOFF), 0.00390611)) {
-            flagsort(ptr, ptr + freqs[i], idx - 1);
+            flagsort(ptr, ptr + freqs[i], idx - 1, inplace);
         } else if (expectp((freqs[i] > 1), 0.3847)) {
             std::sort(ptr, ptr + freqs[i]);
         }
@@ -169,6 +193,163 @@ static void flagsort( T * begin, T * end, int idx ) {
     }
 }
 
+//-----------------------------------------------------------------------------
+// Sorts a list whose items all have the same most-significant byte.
+template <typename T>
+static void blobsort_bucket( T * begin, T * end, bool inplace ) {
+    const size_t count = end - begin;
+
+    if (count < 2) {
+        return;
+    } else if (count <= SORT_CUTOFF) {
+        return std::sort(begin, end);
+    }
+
+    if ((sizeof(T) > 8) || inplace) {
+        flagsort(begin, end, sizeof(T) - 2, inplace);
+    } else {
+        radixsort(begin, end);
+    }
+}
+
+//-----------------------------------------------------------------------------
+// This is a parallel MSB radix partition, followed by sorting each
+// partition on its remaining bytes, using the same sorts as blobsort().
+//
+// The list is split into one contiguous slice per thread, and each
+// thread counts the most-significant bytes in its slice. From those
+// counts, each (byte value, thread) pair gets its own region of a
+// scratch area, with each byte value's regions in thread order. Each
+// thread then moves its slice into its regions, so no two threads ever
+// write to the same place. Finally, each partition is copied back and
+// sorted, with partitions handed out to threads largest first.
+//
+// The moves go through a small buffer per byte value, so that items
+// are written to the scratch area a couple of cache lines at a time,
+// instead of one item at a time to 256 different places.
+//
+// Unlike flagsort(), this needs a scratch copy of the whole list. If
+// inplace is true, then the items are instead partitioned in place by
+// one thread, as flagsort() does, and the partitions are sorted in
+// place.
+static const size_t PARALLEL_SORT_MIN = 1 << 20;
+
+template <typename T>
+static void parallel_radix_scatter( const T * begin, const T * end, T * to, size_t * offsets ) {
+    const uint32_t MSB      = sizeof(T) - 1;
+    const uint32_t WC_ITEMS = (sizeof(T) >= 64) ? 1 : (128 / sizeof(T));
+
+    T        wcbuf[RADIX_SIZE][WC_ITEMS];
+    uint32_t wcfill[RADIX_SIZE] = {};
+
+    for (const T * ptr = begin; ptr < end; ptr++) {
+        uint8_t value = (*ptr)[MSB];
+        wcbuf[value][wcfill[value]++] = *ptr;
+        if (wcfill[value] == WC_ITEMS) {
+            std::copy(wcbuf[value], wcbuf[value] + WC_ITEMS, to + offsets[value]);
+            offsets[value] += WC_ITEMS;
+            wcfill[value]   = 0;
+        }
+    }
+    for (uint32_t i = 0; i < RADIX_SIZE; i++) {
+        std::copy(wcbuf[i], wcbuf[i] + wcfill[i], to + offsets[i]);
+    }
+}
+
+template <typename T>
+static void parallel_blobsort( T * begin, T * end, unsigned nthreads, bool inplace ) {
+#if defined(HAVE_THREADS)
+    const uint32_t MSB   = sizeof(T) - 1;
+    const size_t   count = end - begin;
+
+    std::vector<size_t>      offsets( (size_t)nthreads * RADIX_SIZE );
+    std::vector<std::thread> threads( nthreads );
+
+    for (unsigned t = 0; t < nthreads; t++) {
+        threads[t] = std::thread([ &, t ] {
+                const T * ptr  = begin + count * t / nthreads;
+                const T * last = begin + count * (t + 1) / nthreads;
+                size_t * freqs = &offsets[(size_t)t * RADIX_SIZE];
+                for (; ptr < last; ptr++) {
+                    ++freqs[(*ptr)[MSB]];
+                }
+            });
+    }
+    for (unsigned t = 0; t < nthreads; t++) {
+        threads[t].join();
+    }
+
+    // Turn the counts into starting offsets for each thread's region
+    // of each partition.
+    size_t partition[RADIX_SIZE + 1];
+    size_t freqs[RADIX_SIZE];
+    size_t next = 0;
+    for (uint32_t i = 0; i < RADIX_SIZE; i++) {
+        partition[i] = next;
+        for (unsigned t = 0; t < nthreads; t++) {
+            size_t freq = offsets[(size_t)t * RADIX_SIZE + i];
+            offsets[(size_t)t * RADIX_SIZE + i] = next;
+            next += freq;
+        }
+        freqs[i] = next - partition[i];
+        // If every item has the same top byte, then there's nothing to
+        // partition.
+        if (freqs[i] == count) {
+            return blobsort_bucket(begin, end, inplace);
+        }
+    }
+    partition[RADIX_SIZE] = count;
+
+    std::unique_ptr<T[]> scratch;
+    if (inplace) {
+        flagpartition(begin, freqs, MSB);
+    } else {
+        scratch.reset(new T[count]);
+        for (unsigned t = 0; t < nthreads; t++) {
+            threads[t] = std::thread([ &, t ] {
+                    parallel_radix_scatter(begin + count * t / nthreads, begin + count * (t + 1) / nthreads,
+                            scratch.get(), &offsets[(size_t)t * RADIX_SIZE]);
+                });
+        }
+        for (unsigned t = 0; t < nthreads; t++) {
+            threads[t].join();
+        }
+    }
+
+    uint32_t order[RADIX_SIZE];
+    for (uint32_t i = 0; i < RADIX_SIZE; i++) {
+        order[i] = i;
+    }
+    std::sort(order, order + RADIX_SIZE, [&]( uint32_t a, uint32_t b ) {
+            return (partition[a + 1] - partition[a]) > (partition[b + 1] - partition[b]);
+        });
+
+    std::atomic<uint32_t> nextpart( 0 );
+    for (unsigned t = 0; t < nthreads; t++) {
+        threads[t] = std::thread([ & ] {
+                uint32_t i;
+                while ((i = nextpart++) < RADIX_SIZE) {
+                    const uint32_t part = order[i];
+                    if (!inplace) {
+                        std::copy(scratch.get() + partition[part], scratch.get() + partition[part + 1],
+                                begin + partition[part]);
+                    }
+                    blobsort_bucket(begin + partition[part], begin + partition[part + 1], inplace);
+                }
+            });
+    }
+    for (unsigned t = 0; t < nthreads; t++) {
+        threads[t].join();
+    }
+#else
+    if ((sizeof(T) > 8) || inplace) {
+        flagsort(begin, end, sizeof(T) - 1, inplace);
+    } else {
+        radixsort(begin, end);
+    }
+#endif
+}
+
 //-----------------------------------------------------------------------------
 // For 32-bit values, radix sorting is a clear win on my system, while for 64-bit
 // values radix sorting wins for more common cases but loses for some degenerate
@@ -176,8 +357,14 @@ static void flagsort( T * begin, T * end, int idx ) {
 // why that is, so some more effort into finding the right cutoff for the more
 // general case might be appropriate. This approach overwhelmingly beats just using
 // std::sort, at least on my system.
+//
+// Large lists are sorted by parallel_blobsort() if more than one
+// thread is allowed. If sorting out-of-place would need more than
+// scratchmax bytes of scratch space, then the list is sorted in place,
+// even for smaller items.
 template <class Iter>
-static void blobsort( Iter iter_begin, Iter iter_end ) {
+static void blobsort( Iter iter_begin, Iter iter_end, unsigned nthreads = g_NCPU,
+        size_t scratchmax = g_blobsortScratchMax ) {
     typedef typename std::iterator_traits<Iter>::value_type T;
     // Nothing to sort if there are 0 or 1 items
     if ((iter_end - iter_begin) < 2) {
@@ -188,8 +375,11 @@ static void blobsort( Iter iter_begin, Iter iter_end ) {
 
     T * begin = &(*iter_begin);
     T * end   = &(*iter_end  );
-    if (sizeof(T) > 8) {
-        flagsort(begin, end, sizeof(T) - 1);
+    const bool inplace = ((size_t)(end - begin) * sizeof(T)) > scratchmax;
+    if ((nthreads > 1) && ((size_t)(end - begin) >= PARALLEL_SORT_MIN)) {
+        parallel_blobsort(begin, end, nthreads, inplace);
+    } else if ((sizeof(T) > 8) || inplace) {
+        flagsort(begin, end, sizeof(T) - 1, inplace);
     } else {
         radixsort(begin, end);
     }
@@ -0,0 +1,244 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "Platform.h"
+
+#include <vector>
+#include <new>
+#include <algorithm>
+
+#if defined(__linux__)
+  #include <sys/mman.h>
+#endif
+#if defined(HAVE_THREADS)
+  #include <mutex>
+#endif
+
+#include "HugePages.h"
+
+//-----------------------------------------------------------------------------
+// Only Linux is supported for now. Elsewhere, HugePageAlloc() is just
+// calloc(), and no huge pages are ever reported.
+
+static bool g_hugepagesEnabled = false;
+
+static const size_t HUGEPAGE_SIZE = 2 * 1024 * 1024;
+
+static size_t hugepage_round( size_t bytes ) {
+    return (bytes + HUGEPAGE_SIZE - 1) & ~(HUGEPAGE_SIZE - 1);
+}
+
+// Totals for HugePagesReport(). Memory is measured just before it is
+// freed, when as much of it has been touched as ever will be. Reading
+// smaps is far too slow to do on every free, so each power-of-two size
+// class is only measured once, and that fraction is applied to every
+// allocation of that class.
+static uint64_t allocs_total;
+static uint64_t allocs_hugetlb;
+static double   bytes_measured;
+static double   bytes_huge;
+static bool     class_sampled[64];
+static double   class_fraction[64];
+
+#if defined(HAVE_THREADS)
+static std::mutex stats_mutex;
+#endif
+
+void HugePagesEnable( void ) {
+    g_hugepagesEnabled = true;
+}
+
+bool HugePagesEnabled( void ) {
+    return g_hugepagesEnabled;
+}
+
+// Must be called with stats_mutex held
+static double sample_fraction( const void * ptr, size_t bytes ) {
+    const size_t len = hugepage_round(bytes);
+    unsigned     sizeclass = 0;
+
+    while ((len >> sizeclass) > 1) {
+        sizeclass++;
+    }
+    if (!class_sampled[sizeclass]) {
+        class_fraction[sizeclass] = HugePageFraction(ptr);
+        class_sampled[sizeclass]  = true;
+    }
+    return class_fraction[sizeclass];
+}
+
+double HugePageSampleFraction( const void * ptr, size_t bytes ) {
+#if defined(HAVE_THREADS)
+    std::lock_guard<std::mutex> lock( stats_mutex );
+#endif
+    return sample_fraction(ptr, bytes);
+}
+
+//-----------------------------------------------------------------------------
+
+void * HugePageAlloc( size_t bytes ) {
+#if defined(__linux__)
+    const int prot  = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+
+    if (!g_hugepagesEnabled) {
+        void * ptr = mmap(NULL, bytes, prot, flags, -1, 0);
+        return (ptr == MAP_FAILED) ? NULL : ptr;
+    }
+
+    const size_t len = hugepage_round(bytes);
+
+    // Explicit huge pages are only available if the administrator has
+    // reserved some, so this usually fails.
+  #if defined(MAP_HUGETLB)
+    void * ptr = mmap(NULL, len, prot, flags | MAP_HUGETLB, -1, 0);
+    if (ptr != MAP_FAILED) {
+  #if defined(HAVE_THREADS)
+        std::lock_guard<std::mutex> lock( stats_mutex );
+  #endif
+        allocs_total++;
+        allocs_hugetlb++;
+        return ptr;
+    }
+  #endif
+
+    // Otherwise, ask for transparent huge pages. Those can only be used
+    // for huge-page-aligned ranges, so the mapping is over-allocated and
+    // then trimmed down to an aligned region.
+    uint8_t * raw = (uint8_t *)mmap(NULL, len + HUGEPAGE_SIZE, prot, flags, -1, 0);
+    if (raw == MAP_FAILED) {
+        return NULL;
+    }
+    uint8_t *    start = (uint8_t *)(((uintptr_t)raw + HUGEPAGE_SIZE - 1) & ~(uintptr_t)(HUGEPAGE_SIZE - 1));
+    const size_t head  = start - raw;
+    if (head > 0) {
+        munmap(raw, head);
+    }
+    munmap(start + len, HUGEPAGE_SIZE - head);
+  #if defined(MADV_HUGEPAGE)
+    madvise(start, len, MADV_HUGEPAGE);
+  #endif
+    {
+  #if defined(HAVE_THREADS)
+        std::lock_guard<std::mutex> lock( stats_mutex );
+  #endif
+        allocs_total++;
+    }
+    return start;
+#else
+    return calloc(1, bytes);
+#endif
+}
+
+void HugePageFree( void * ptr, size_t bytes ) {
+    if (ptr == NULL) {
+        return;
+    }
+#if defined(__linux__)
+    if (!g_hugepagesEnabled) {
+        munmap(ptr, bytes);
+        return;
+    }
+
+    // HugePageFraction() describes the whole mapping around ptr, which
+    // may have been merged with neighbouring allocations, so that
+    // fraction is applied to this allocation's size.
+    {
+  #if defined(HAVE_THREADS)
+        std::lock_guard<std::mutex> lock( stats_mutex );
+  #endif
+        const double frac = sample_fraction(ptr, bytes);
+        if (frac >= 0.0) {
+            bytes_measured += (double)bytes;
+            bytes_huge     += frac * (double)bytes;
+        }
+    }
+    munmap(ptr, hugepage_round(bytes));
+#else
+    free(ptr);
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// /proc/self/smaps lists each mapping of the process, followed by its
+// statistics. Mappings from the hugetlbfs pool have a large
+// KernelPageSize; transparent huge pages show up as AnonHugePages.
+
+double HugePageFraction( const void * ptr ) {
+#if defined(__linux__)
+    FILE * f = fopen("/proc/self/smaps", "r");
+
+    if (f == NULL) {
+        return -1.0;
+    }
+
+    const uintptr_t addr     = (uintptr_t)ptr;
+    bool            found    = false;
+    unsigned long   rss      = 0, anonhuge = 0, pagesize = 0;
+    char            line[512];
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        unsigned long start, end;
+        if (sscanf(line, "%lx-%lx ", &start, &end) == 2) {
+            if (found) {
+                break;
+            }
+            found = (addr >= start) && (addr < end);
+            continue;
+        }
+        if (!found) {
+            continue;
+        }
+        sscanf(line, "Rss: %lu kB"           , &rss     );
+        sscanf(line, "AnonHugePages: %lu kB" , &anonhuge);
+        sscanf(line, "KernelPageSize: %lu kB", &pagesize);
+    }
+    fclose(f);
+
+    if (!found) {
+        return -1.0;
+    }
+    if (pagesize > 4) {
+        return 1.0;
+    }
+    if (rss == 0) {
+        return 0.0;
+    }
+    return std::min((double)anonhuge / (double)rss, 1.0);
+#else
+    return -1.0;
+#endif
+}
+
+void HugePagesReport( void ) {
+    if (!g_hugepagesEnabled) {
+        return;
+    }
+
+    printf("Huge pages: %" PRIu64 " large allocations (%" PRIu64 " from the hugetlbfs pool)",
+            allocs_total, allocs_hugetlb);
+    if (bytes_measured > 0.0) {
+        printf(", %.1f%% of their memory was backed by huge pages\n", 100.0 * bytes_huge / bytes_measured);
+    } else {
+        printf("\n");
+    }
+    if ((allocs_total > 0) && (bytes_huge == 0.0)) {
+        printf("WARNING: --hugepages was given, but no huge pages were obtained; check "
+                "/sys/kernel/mm/transparent_hugepage/enabled\n");
+    }
+}
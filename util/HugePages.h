@@ -0,0 +1,105 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+//-----------------------------------------------------------------------------
+// Large buffers can be backed by huge pages, so that dTLB misses don't
+// distort bulk speed results or slow down analysis of big keysets.
+// This is off by default, and is turned on by the --hugepages option.
+//
+// HugePagesEnable() must be called before any memory is allocated
+// through this interface, since allocations made with it enabled must
+// be freed with it enabled.
+void HugePagesEnable( void );
+bool HugePagesEnabled( void );
+
+// Allocate or free memory directly from the OS. When huge pages are
+// enabled, the allocation is a whole number of huge pages, taken from
+// the hugetlbfs pool if possible, and otherwise marked as wanting
+// transparent huge pages. The memory is zeroed. Returns NULL on
+// failure.
+void * HugePageAlloc( size_t bytes );
+void HugePageFree( void * ptr, size_t bytes );
+
+// The fraction of the memory currently resident around ptr which is
+// backed by huge pages, or -1.0 if unknown (e.g. on non-Linux
+// systems). This is only meaningful once the memory has been touched.
+// It parses /proc/self/smaps, so it is slow.
+double HugePageFraction( const void * ptr );
+
+// The same, for an allocation of the given size from HugePageAlloc(),
+// but only measured for the first allocation of each power-of-two size
+// class; later calls for that class return the cached result.
+double HugePageSampleFraction( const void * ptr, size_t bytes );
+
+// Prints how much of the memory allocated through HugePageAlloc()
+// actually got huge pages, if huge pages are enabled.
+void HugePagesReport( void );
+
+//-----------------------------------------------------------------------------
+// An allocator for large containers, such as the lists of hashes in
+// the keyset tests. Allocations of at least HUGEPAGE_MIN_ALLOC bytes go
+// through HugePageAlloc() when huge pages are enabled; everything else
+// uses malloc().
+
+static const size_t HUGEPAGE_MIN_ALLOC = 1024 * 1024;
+
+template <typename T>
+class HugePageAllocator {
+  public:
+    typedef T value_type;
+
+    HugePageAllocator() = default;
+
+    template <typename U>
+    HugePageAllocator( const HugePageAllocator<U> & ) {}
+
+    T * allocate( size_t n ) {
+        const size_t bytes = n * sizeof(T);
+        void *       ptr   = usehuge(bytes) ? HugePageAlloc(bytes) : malloc(bytes);
+
+        if (ptr == NULL) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(ptr);
+    }
+
+    void deallocate( T * ptr, size_t n ) {
+        const size_t bytes = n * sizeof(T);
+
+        if (usehuge(bytes)) {
+            HugePageFree(ptr, bytes);
+        } else {
+            free(ptr);
+        }
+    }
+
+  private:
+    static bool usehuge( size_t bytes ) {
+        return (bytes >= HUGEPAGE_MIN_ALLOC) && HugePagesEnabled();
+    }
+};
+
+template <typename T, typename U>
+bool operator ==( const HugePageAllocator<T> &, const HugePageAllocator<U> & ) { return true; }
+
+template <typename T, typename U>
+bool operator !=( const HugePageAllocator<T> &, const HugePageAllocator<U> & ) { return false; }
+
+template <typename T>
+using hugevector = std::vector<T, HugePageAllocator<T>>;
@@ -0,0 +1,221 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "Platform.h"
+
+#include "PerfCounters.h"
+
+#include <cerrno>
+
+#if defined(__linux__)
+  #include <linux/perf_event.h>
+  #include <sys/syscall.h>
+  #include <sys/ioctl.h>
+  #include <unistd.h>
+  #define HAVE_PERF_EVENTS
+#endif
+
+static const char * const perf_names[PERF_COUNTER_COUNT] = {
+    "insns", "cycles", "br-miss", "L1D-miss", "LLC-miss"
+};
+
+static bool perf_active = false;
+
+#if defined(HAVE_PERF_EVENTS)
+
+static int perf_fds[PERF_COUNTER_COUNT];
+static int perf_leader = -1;
+
+// Counters in the order they were added to the group, which is the
+// order read() returns them in.
+static int perf_order[PERF_COUNTER_COUNT];
+static int perf_ncounters = 0;
+
+static int perf_open( int id, int group_fd ) {
+    struct perf_event_attr attr;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    switch (id) {
+    case PERF_INSTRUCTIONS:
+        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case PERF_CYCLES:
+        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case PERF_BRANCH_MISSES:
+        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case PERF_L1D_MISSES:
+        attr.type   = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    case PERF_LLC_MISSES:
+        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+    default:
+        return -1;
+    }
+    attr.disabled       = (group_fd == -1) ? 1 : 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv     = 1;
+    attr.read_format    = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+// Returns false if the group could not be scheduled at all.
+static bool perf_read( PerfCounts & counts ) {
+    uint64_t buf[3 + PERF_COUNTER_COUNT];
+
+    if (read(perf_leader, buf, sizeof(buf)) < (ssize_t)(3 * sizeof(uint64_t))) {
+        return false;
+    }
+
+    const uint64_t nr = buf[0], enabled = buf[1], running = buf[2];
+    if ((running == 0) || (nr != (uint64_t)perf_ncounters)) {
+        return false;
+    }
+    // Scale up if the group was multiplexed with other events
+    const double scale = (double)enabled / (double)running;
+    for (int i = 0; i < perf_ncounters; i++) {
+        counts.count[perf_order[i]] += (uint64_t)((double)buf[3 + i] * scale);
+    }
+    return true;
+}
+
+bool PerfCountersEnable( void ) {
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        perf_fds[id] = perf_open(id, perf_leader);
+        if (perf_fds[id] < 0) {
+            continue;
+        }
+        if (perf_leader == -1) {
+            perf_leader = perf_fds[id];
+        }
+        perf_order[perf_ncounters++] = id;
+    }
+
+    if (perf_leader == -1) {
+        printf("WARNING: hardware performance counters are unavailable (%s); continuing without them\n",
+                strerror(errno));
+        return false;
+    }
+
+    // The whole group is only counted if the PMU can fit it all at
+    // once. If a trial run shows it can't, drop counters from the end
+    // until it fits.
+    perf_active = true;
+    for (;;) {
+        PerfCounts trial;
+        PerfCountsClear(trial);
+        PerfCountersStart();
+        ioctl(perf_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (perf_read(trial) || (perf_ncounters == 1)) {
+            break;
+        }
+        const int id = perf_order[--perf_ncounters];
+        close(perf_fds[id]);
+        perf_fds[id] = -1;
+    }
+
+    printf("Hardware performance counters:");
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        bool have = false;
+        for (int i = 0; i < perf_ncounters; i++) {
+            have |= (perf_order[i] == id);
+        }
+        printf(" %s%s", perf_names[id], have ? "" : " (unavailable)");
+    }
+    printf("\n");
+
+    return true;
+}
+
+void PerfCountersStart( void ) {
+    if (!perf_active) {
+        return;
+    }
+    ioctl(perf_leader, PERF_EVENT_IOC_RESET , PERF_IOC_FLAG_GROUP);
+    ioctl(perf_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCountersStop( PerfCounts & counts ) {
+    if (!perf_active) {
+        return;
+    }
+    ioctl(perf_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    bool counted[PERF_COUNTER_COUNT] = { false };
+    if (perf_read(counts)) {
+        for (int i = 0; i < perf_ncounters; i++) {
+            counted[perf_order[i]] = true;
+        }
+    }
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        counts.valid[id] &= counted[id];
+    }
+}
+
+#else
+
+bool PerfCountersEnable( void ) {
+    printf("WARNING: hardware performance counters are not supported on this platform\n");
+    return false;
+}
+
+void PerfCountersStart( void ) {}
+
+void PerfCountersStop( PerfCounts & counts ) {}
+
+#endif
+
+bool PerfCountersActive( void ) {
+    return perf_active;
+}
+
+void PerfCountsClear( PerfCounts & counts ) {
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        counts.count[id] = 0;
+        counts.valid[id] = true;
+    }
+}
+
+void PerfCountsPrint( const PerfCounts & counts, const char * opname, double ops, double bytes ) {
+    if (!perf_active || (ops <= 0.0)) {
+        return;
+    }
+    printf("    perf:");
+    if (counts.valid[PERF_INSTRUCTIONS] && counts.valid[PERF_CYCLES] && (counts.count[PERF_CYCLES] != 0)) {
+        printf(" %5.2f IPC,", (double)counts.count[PERF_INSTRUCTIONS] / (double)counts.count[PERF_CYCLES]);
+    }
+    printf(" per %s:", opname);
+    for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+        if (counts.valid[id]) {
+            printf(" %s %.2f", perf_names[id], (double)counts.count[id] / ops);
+        } else {
+            printf(" %s n/a", perf_names[id]);
+        }
+    }
+    if (bytes > 0.0) {
+        printf(" - per byte:");
+        for (int id = 0; id < PERF_COUNTER_COUNT; id++) {
+            if (counts.valid[id]) {
+                printf(" %s %.4f", perf_names[id], (double)counts.count[id] / bytes);
+            }
+        }
+    }
+    printf("\n");
+}
@@ -0,0 +1,59 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+//-----------------------------------------------------------------------------
+// Optional hardware performance counters, for speed tests to report
+// alongside their timings. These use perf_event_open() on Linux, and
+// are unavailable elsewhere or when the kernel won't allow them; in
+// that case PerfCountersActive() is false and callers just skip
+// reporting. Counts cover only the calling thread.
+
+enum PerfCounterId {
+    PERF_INSTRUCTIONS,
+    PERF_CYCLES,
+    PERF_BRANCH_MISSES,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_COUNTER_COUNT
+};
+
+struct PerfCounts {
+    uint64_t  count[PERF_COUNTER_COUNT];
+    bool      valid[PERF_COUNTER_COUNT];
+};
+
+// Try to set up the counters, and print what is available. Returns
+// true if at least one counter can be used.
+bool PerfCountersEnable( void );
+
+bool PerfCountersActive( void );
+
+// Zero all entries of counts, marking every counter valid, so that
+// PerfCountersStop() results can be accumulated into it.
+void PerfCountsClear( PerfCounts & counts );
+
+// Counting is between Start() and Stop(). Stop() adds the counts to
+// the given accumulator, and marks any counter that did not count as
+// invalid.
+void PerfCountersStart( void );
+void PerfCountersStop( PerfCounts & counts );
+
+// Print a one-line summary of counts, per operation (e.g. per hash)
+// and, if bytes is non-zero, per byte.
+void PerfCountsPrint( const PerfCounts & counts, const char * opname, double ops, double bytes );
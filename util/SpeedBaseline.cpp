@@ -0,0 +1,295 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "Platform.h"
+
+#include <vector>
+#include <string>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <cerrno>
+
+#include "TestGlobals.h" // For g_failstr
+#include "SysInfo.h"
+#include "SpeedBaseline.h"
+
+//-----------------------------------------------------------------------------
+// The baseline file is JSON Lines: one flat JSON object per result.
+// This is easy to append to, diff, and process with other tools.
+
+struct SpeedResult {
+    std::string  hash;
+    std::string  metric;
+    std::string  cpu;
+    std::string  compiler;
+    std::string  commit;
+    double       cycles;
+    double       relstdv;
+};
+
+static std::vector<SpeedResult> results;
+
+// Differences smaller than this are never flagged, however quiet the
+// measurements were. Larger differences are flagged if they exceed
+// BASELINE_SIGMAS combined relative standard deviations.
+constexpr double BASELINE_MIN_TOLERANCE = 0.05;
+constexpr double BASELINE_SIGMAS        = 2.0;
+
+static const char * compiler_name( void ) {
+#if defined(__clang__)
+    return "clang " __clang_version__;
+#elif defined(__GNUC__)
+    return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    return "msvc";
+#else
+    return "unknown";
+#endif
+}
+
+void SpeedBaselineRecord( const char * hash, const std::string & metric, double cycles, double stdv ) {
+    static const std::string cpu = GetCPUModel();
+    SpeedResult result;
+
+    result.hash     = hash;
+    result.metric   = metric;
+    result.cpu      = cpu;
+    result.compiler = compiler_name();
+    result.cycles   = cycles;
+    result.relstdv  = (cycles > 0.0) ? (stdv / cycles) : 0.0;
+    results.push_back(result);
+}
+
+//-----------------------------------------------------------------------------
+
+static void write_json_string( FILE * f, const std::string & str ) {
+    fputc('"', f);
+    for (char c: str) {
+        if ((c == '"') || (c == '\\')) {
+            fputc('\\', f);
+            fputc(c, f);
+        } else if ((unsigned char)c < 0x20) {
+            fprintf(f, "\\u%04x", (unsigned char)c);
+        } else {
+            fputc(c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static void write_result( FILE * f, const SpeedResult & result ) {
+    fprintf(f, "{\"hash\": "     ); write_json_string(f, result.hash    );
+    fprintf(f, ", \"metric\": "  ); write_json_string(f, result.metric  );
+    fprintf(f, ", \"cycles\": %.4f, \"relstdv\": %.6f", result.cycles, result.relstdv);
+    fprintf(f, ", \"cpu\": "     ); write_json_string(f, result.cpu     );
+    fprintf(f, ", \"compiler\": "); write_json_string(f, result.compiler);
+    fprintf(f, ", \"commit\": "  ); write_json_string(f, result.commit  );
+    fprintf(f, "}\n");
+}
+
+// Parses the flat objects written by write_result(). This is not a
+// general JSON parser; it only handles string and number values.
+static bool parse_result( const char * line, SpeedResult & result ) {
+    std::map<std::string, std::string> fields;
+    const char * p = line;
+
+    auto skipws = [&]() {
+        while ((*p == ' ') || (*p == '\t') || (*p == '\r') || (*p == '\n')) { p++; }
+    };
+    auto parse_string = [&]( std::string & out ) {
+        out.clear();
+        if (*p++ != '"') { return false; }
+        while (*p != '"') {
+            if (*p == '\0') { return false; }
+            if (*p == '\\') {
+                p++;
+                if (*p == 'u') {
+                    unsigned c;
+                    if (sscanf(p + 1, "%4x", &c) != 1) { return false; }
+                    out += (char)c;
+                    p   += 5;
+                    continue;
+                }
+                if (*p == '\0') { return false; }
+            }
+            out += *p++;
+        }
+        p++;
+        return true;
+    };
+
+    skipws();
+    if (*p++ != '{') { return false; }
+    for (;;) {
+        std::string key, value;
+        skipws();
+        if (!parse_string(key)) { return false; }
+        skipws();
+        if (*p++ != ':') { return false; }
+        skipws();
+        if (*p == '"') {
+            if (!parse_string(value)) { return false; }
+        } else {
+            size_t len = strcspn(p, ",} \t\r\n");
+            value.assign(p, len);
+            p += len;
+        }
+        fields[key] = value;
+        skipws();
+        if (*p == '}') { break; }
+        if (*p++ != ',') { return false; }
+    }
+
+    result.hash     = fields["hash"];
+    result.metric   = fields["metric"];
+    result.cpu      = fields["cpu"];
+    result.compiler = fields["compiler"];
+    result.commit   = fields["commit"];
+    result.cycles   = strtod(fields["cycles" ].c_str(), NULL);
+    result.relstdv  = strtod(fields["relstdv"].c_str(), NULL);
+
+    return !result.hash.empty() && !result.metric.empty() && (result.cycles > 0.0);
+}
+
+// A missing file is an empty baseline, not an error.
+static bool load_results( const char * filename, std::vector<SpeedResult> & loaded, bool & missing ) {
+    FILE * f = fopen(filename, "r");
+    char   buf[4096];
+    bool   ok = true;
+
+    missing = (f == NULL);
+    if (f == NULL) {
+        return errno == ENOENT;
+    }
+    while (ok && (fgets(buf, sizeof(buf), f) != NULL)) {
+        SpeedResult result;
+        if (buf[strspn(buf, " \t\r\n")] == '\0') {
+            continue;
+        }
+        ok = parse_result(buf, result);
+        loaded.push_back(result);
+    }
+    fclose(f);
+
+    return ok;
+}
+
+static bool same_result( const SpeedResult & a, const SpeedResult & b ) {
+    return (a.hash == b.hash) && (a.metric == b.metric) && (a.cpu == b.cpu) && (a.compiler == b.compiler);
+}
+
+//-----------------------------------------------------------------------------
+
+bool SpeedBaselineSave( const char * filename, const char * commit ) {
+    std::vector<SpeedResult> stored;
+    bool missing;
+
+    if (!load_results(filename, stored, missing)) {
+        printf("WARNING: could not parse speed baseline \"%s\"; not overwriting it\n", filename);
+        return false;
+    }
+
+    FILE * f = fopen(filename, "w");
+    if (f == NULL) {
+        printf("WARNING: could not write speed baseline \"%s\"\n", filename);
+        return false;
+    }
+    for (const SpeedResult & old: stored) {
+        bool replaced = false;
+        for (const SpeedResult & result: results) {
+            replaced |= same_result(old, result);
+        }
+        if (!replaced) {
+            write_result(f, old);
+        }
+    }
+    for (SpeedResult & result: results) {
+        result.commit = commit;
+        write_result(f, result);
+    }
+    if (fclose(f) != 0) {
+        printf("WARNING: could not write speed baseline \"%s\"\n", filename);
+        return false;
+    }
+
+    printf("Saved %zu speed results to baseline \"%s\"\n", results.size(), filename);
+    return true;
+}
+
+int SpeedBaselineCheck( const char * filename, bool verbose ) {
+    std::vector<SpeedResult> stored;
+    bool missing;
+
+    if (!load_results(filename, stored, missing) || missing) {
+        printf("WARNING: could not read speed baseline \"%s\"\n", filename);
+        return -1;
+    }
+
+    printf("[[[ Speed Baseline Check ]]]\n\n");
+    printf("Checking against \"%s\"; differences over max(%.0f%%, %.0f combined stdvs) are flagged\n\n",
+            filename, 100.0 * BASELINE_MIN_TOLERANCE, BASELINE_SIGMAS);
+
+    int         regressed = 0, improved = 0, unmatched = 0, checked = 0;
+    std::string lasthash;
+
+    for (const SpeedResult & result: results) {
+        // Later entries in the file win, though save never leaves duplicates
+        const SpeedResult * base = NULL;
+        for (const SpeedResult & old: stored) {
+            if (same_result(old, result)) {
+                base = &old;
+            }
+        }
+        if (base == NULL) {
+            unmatched++;
+            continue;
+        }
+
+        const double delta     = result.cycles / base->cycles - 1.0;
+        const double tolerance = std::max(BASELINE_MIN_TOLERANCE,
+                BASELINE_SIGMAS * std::sqrt(result.relstdv * result.relstdv + base->relstdv * base->relstdv));
+        const char * verdict   = "";
+
+        checked++;
+        if (delta > tolerance) {
+            verdict = "REGRESSION";
+            regressed++;
+        } else if (delta < -tolerance) {
+            verdict = "improved";
+            improved++;
+        } else if (!verbose) {
+            continue;
+        }
+
+        if (lasthash != result.hash) {
+            printf("%s (baseline from %s)\n", result.hash.c_str(), base->commit.c_str());
+            lasthash = result.hash;
+        }
+        printf("  %-28s %12.2f -> %12.2f cycles  %+7.2f%% (tolerance %5.2f%%)  %s\n", result.metric.c_str(),
+                base->cycles, result.cycles, 100.0 * delta, 100.0 * tolerance, verdict);
+    }
+
+    printf("\n%d of %d results regressed, %d improved", regressed, checked, improved);
+    if (unmatched > 0) {
+        printf(", and %d had no baseline for this hash, CPU, and compiler", unmatched);
+    }
+    printf("\n%s\n", (regressed > 0) ? g_failstr : "");
+
+    return regressed;
+}
@@ -0,0 +1,40 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+//-----------------------------------------------------------------------------
+// Speed baselines: the speed tests record their results here, so that
+// they can be saved to a file, or checked against one saved earlier to
+// catch performance regressions.
+//
+// Results are stored as cycles per unit of work (so lower is always
+// better), along with their relative standard deviation. Each one is
+// tagged with the CPU model and compiler that produced it, and results
+// are only compared against a baseline from the same CPU and compiler.
+
+void SpeedBaselineRecord( const char * hash, const std::string & metric, double cycles, double stdv );
+
+// Write all results recorded so far to filename. Any results already
+// in that file for the same hash, metric, CPU, and compiler are
+// replaced; everything else in it is kept. Returns false on error.
+bool SpeedBaselineSave( const char * filename, const char * commit );
+
+// Compare all results recorded so far against those in filename, and
+// print any significant differences (or every comparison, if verbose
+// is true). Returns the number of regressions, or -1 on error.
+int SpeedBaselineCheck( const char * filename, bool verbose );
@@ -56,6 +56,7 @@
 #include <algorithm>
 #include <math.h>
 
+#include "Random.h"
 #include "Stats.h"
 
 //-----------------------------------------------------------------------------
@@ -185,6 +186,96 @@ void FilterOutliers2( std::vector<double> & v ) {
 
 #endif
 
+//-----------------------------------------------------------------------------
+// Order statistics and two-sample comparisons, for speed results, which
+// are far from normally distributed.
+
+// Sorts v in place.
+double CalcMedian( std::vector<double> & v ) {
+    const size_t sz = v.size();
+
+    std::sort(v.begin(), v.end());
+    if (sz == 0) {
+        return 0.0;
+    }
+    if (sz & 1) {
+        return v[sz / 2];
+    }
+    return (v[sz / 2 - 1] + v[sz / 2]) / 2.0;
+}
+
+// Two-sided p-value of the Mann-Whitney U test that a and b come from
+// the same distribution, using the normal approximation with a
+// correction for ties and for continuity.
+double MannWhitneyPValue( const std::vector<double> & a, const std::vector<double> & b ) {
+    const double na = a.size();
+    const double nb = b.size();
+    const double n  = na + nb;
+
+    if ((na == 0) || (nb == 0)) {
+        return 1.0;
+    }
+
+    std::vector<std::pair<double, bool>> all;
+    all.reserve(a.size() + b.size());
+    for (double x: a) { all.emplace_back(x, true ); }
+    for (double x: b) { all.emplace_back(x, false); }
+    std::sort(all.begin(), all.end());
+
+    // Sum the (tie-averaged) ranks of a's values
+    double ranksum = 0.0;
+    double ties    = 0.0;
+    for (size_t i = 0; i < all.size();) {
+        size_t j = i;
+        while ((j < all.size()) && (all[j].first == all[i].first)) {
+            j++;
+        }
+        const double t    = j - i;
+        const double rank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; k++) {
+            if (all[k].second) {
+                ranksum += rank;
+            }
+        }
+        ties += t * t * t - t;
+        i     = j;
+    }
+
+    const double u     = ranksum - na * (na + 1.0) / 2.0;
+    const double mu    = na * nb / 2.0;
+    const double sigma = sqrt(na * nb / 12.0 * ((n + 1.0) - ties / (n * (n - 1.0))));
+
+    if (sigma == 0.0) {
+        return 1.0;
+    }
+
+    const double z = std::max(fabs(u - mu) - 0.5, 0.0) / sigma;
+    return std::min(2.0 * GetNormalPValue(0.0, 1.0, z), 1.0);
+}
+
+// Percentile bootstrap confidence interval for median(b) / median(a).
+void BootstrapMedianRatioCI( const std::vector<double> & a, const std::vector<double> & b,
+        double level, unsigned resamples, uint32_t seed, double & lo, double & hi ) {
+    Rand r( seed );
+    std::vector<double> ratios( resamples );
+    std::vector<double> ra( a.size() ), rb( b.size() );
+
+    for (unsigned i = 0; i < resamples; i++) {
+        for (size_t j = 0; j < ra.size(); j++) {
+            ra[j] = a[r.rand_range(a.size())];
+        }
+        for (size_t j = 0; j < rb.size(); j++) {
+            rb[j] = b[r.rand_range(b.size())];
+        }
+        ratios[i] = CalcMedian(rb) / CalcMedian(ra);
+    }
+    std::sort(ratios.begin(), ratios.end());
+
+    const double tail = (1.0 - level) / 2.0;
+    lo = ratios[(size_t)(tail * (resamples - 1))];
+    hi = ratios[(size_t)((1.0 - tail) * (resamples - 1) + 0.5)];
+}
+
 //-----------------------------------------------------------------------------
 
 double chooseK( int n, int k ) {
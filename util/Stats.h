@@ -56,6 +56,11 @@ double CalcStdv( std::vector<double> & v );
 double CalcStdv( std::vector<double> & v, int a, int b );
 bool ContainsOutlier( std::vector<double> & v, size_t len );
 void FilterOutliers( std::vector<double> & v );
+double CalcMedian( std::vector<double> & v );
+
+double MannWhitneyPValue( const std::vector<double> & a, const std::vector<double> & b );
+void BootstrapMedianRatioCI( const std::vector<double> & a, const std::vector<double> & b,
+        double level, unsigned resamples, uint32_t seed, double & lo, double & hi );
 
 double chooseK( int b, int k );
 double chooseUpToK( int n, int k );
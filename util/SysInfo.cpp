@@ -0,0 +1,320 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+#include "Platform.h"
+#include "Timing.h"
+
+#include <vector>
+#include <string>
+#include <algorithm>
+
+#if defined(__linux__)
+  #include <sched.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+  #include <cpuid.h>
+#endif
+
+#include "Stats.h" // For FilterOutliers, CalcMean
+#include "SysInfo.h"
+
+//-----------------------------------------------------------------------------
+// Cache sizes come from Linux's sysfs. Other systems get no cache
+// information, and callers are expected to cope with that.
+
+static bool read_sysfs_line( const char * path, char * buf, size_t buflen ) {
+    FILE * f = fopen(path, "r");
+
+    if (f == NULL) {
+        return false;
+    }
+    bool ok = (fgets(buf, buflen, f) != NULL);
+    fclose(f);
+    if (ok) {
+        buf[strcspn(buf, "\n")] = '\0';
+    }
+    return ok;
+}
+
+std::vector<CacheLevel> GetDataCaches( void ) {
+    std::vector<CacheLevel> caches;
+
+    for (unsigned idx = 0; idx < 16; idx++) {
+        char path[128], buf[64];
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/type", idx);
+        if (!read_sysfs_line(path, buf, sizeof(buf))) {
+            break;
+        }
+        if (strcmp(buf, "Instruction") == 0) {
+            continue;
+        }
+
+        CacheLevel cache;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/level", idx);
+        if (!read_sysfs_line(path, buf, sizeof(buf)) || (sscanf(buf, "%u", &cache.level) != 1)) {
+            continue;
+        }
+
+        unsigned long long size;
+        char               unit = '\0';
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu0/cache/index%u/size", idx);
+        if (!read_sysfs_line(path, buf, sizeof(buf)) || (sscanf(buf, "%llu%c", &size, &unit) < 1)) {
+            continue;
+        }
+        switch (unit) {
+        case 'K': size <<= 10; break;
+        case 'M': size <<= 20; break;
+        case 'G': size <<= 30; break;
+        default:               break;
+        }
+        cache.size = size;
+        caches.push_back(cache);
+    }
+
+    std::sort(caches.begin(), caches.end(),
+            []( const CacheLevel & a, const CacheLevel & b ) { return a.level < b.level; });
+
+    return caches;
+}
+
+const char * CacheRegime( const std::vector<CacheLevel> & caches, uint64_t bytes ) {
+    static const char * names[] = { "L0", "L1", "L2", "L3", "L4" };
+
+    if (caches.empty()) {
+        return "?";
+    }
+    for (const CacheLevel & cache: caches) {
+        if ((bytes <= cache.size) && (cache.level < (sizeof(names) / sizeof(names[0])))) {
+            return names[cache.level];
+        }
+    }
+    return "DRAM";
+}
+
+//-----------------------------------------------------------------------------
+// CPU affinity is only supported on Linux for now.
+
+std::vector<unsigned> GetAllowedCPUs( void ) {
+    std::vector<unsigned> cpus;
+
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+#endif
+
+    return cpus;
+}
+
+bool SetThreadCPUs( const std::vector<unsigned> & cpus ) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu: cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    // On Linux, pid 0 means the calling thread, not the whole process.
+    return !cpus.empty() && (sched_setaffinity(0, sizeof(set), &set) == 0);
+#else
+    return false;
+#endif
+}
+
+bool PinThreadToCPU( unsigned cpu ) {
+    return SetThreadCPUs(std::vector<unsigned>( 1, cpu ));
+}
+
+int GetCurrentCPU( void ) {
+#if defined(__linux__)
+    return sched_getcpu();
+#else
+    return -1;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+// CPU isolation and frequency scaling settings also come from sysfs.
+
+int IsCPUIsolated( unsigned cpu ) {
+    char buf[1024];
+
+    if (!read_sysfs_line("/sys/devices/system/cpu/isolated", buf, sizeof(buf))) {
+        return -1;
+    }
+    // A list of ranges, like "2-5,8"
+    for (char * p = buf; *p != '\0';) {
+        unsigned lo, hi;
+        int      n;
+        if (sscanf(p, "%u%n", &lo, &n) != 1) {
+            break;
+        }
+        p += n;
+        hi = lo;
+        if ((*p == '-') && (sscanf(p + 1, "%u%n", &hi, &n) == 1)) {
+            p += n + 1;
+        }
+        if ((cpu >= lo) && (cpu <= hi)) {
+            return 1;
+        }
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return 0;
+}
+
+std::string GetCPUGovernor( unsigned cpu ) {
+    char path[128], buf[64];
+
+    snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpufreq/scaling_governor", cpu);
+    if (!read_sysfs_line(path, buf, sizeof(buf))) {
+        return "";
+    }
+    return buf;
+}
+
+//-----------------------------------------------------------------------------
+// The CPU model comes from Linux's /proc/cpuinfo, which names it
+// differently on different architectures.
+
+std::string GetCPUModel( void ) {
+    static const char * const keys[] = { "model name", "Processor", "cpu model", "cpu" };
+    FILE *      f = fopen("/proc/cpuinfo", "r");
+    std::string model;
+    char        buf[512];
+
+    if (f == NULL) {
+        return "unknown";
+    }
+    while (model.empty() && (fgets(buf, sizeof(buf), f) != NULL)) {
+        char * colon = strchr(buf, ':');
+        if (colon == NULL) {
+            continue;
+        }
+        for (const char * key: keys) {
+            size_t keylen = strlen(key);
+            if ((strncmp(buf, key, keylen) == 0) && (strspn(buf + keylen, " \t") == (size_t)(colon - buf - keylen))) {
+                const char * value = colon + 1 + strspn(colon + 1, " \t");
+                model.assign(value, strcspn(value, "\n"));
+                break;
+            }
+        }
+    }
+    fclose(f);
+
+    return model.empty() ? "unknown" : model;
+}
+
+//-----------------------------------------------------------------------------
+// Timer calibration
+
+static uint64_t raw_clock_ns( void ) {
+    struct timespec ts;
+
+#if defined(CLOCK_MONOTONIC_RAW)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+
+static double calibrate_timer( uint64_t duration_ns ) {
+    uint64_t ns_begin = raw_clock_ns();
+    uint64_t ticks_begin = timer_start();
+    uint64_t ns_end;
+
+    while ((ns_end = raw_clock_ns()) - ns_begin < duration_ns) {}
+
+    uint64_t ticks_end = timer_end();
+    ns_end = raw_clock_ns();
+
+    return (double)(ticks_end - ticks_begin) / (double)(ns_end - ns_begin);
+}
+
+// The cost of the timer_start()/timer_end() pair itself, which is
+// included in every timing, so that tests can subtract it. This
+// mirrors SpeedTest's timehash() without the hash calls, and is
+// summarized the same way (the mean of the fastest half, after
+// outlier removal).
+NEVER_INLINE static int64_t timeempty( void ) {
+    volatile int64_t begin, end;
+
+    begin = timer_start();
+    end   = timer_end();
+
+    return end - begin;
+}
+
+static double timer_overhead( void ) {
+    std::vector<double> timevec( 10000 );
+
+    for (size_t i = 0; i < timevec.size(); i++) {
+        timevec[i] = (double)timeempty();
+    }
+    std::sort(timevec.begin(), timevec.end());
+    FilterOutliers(timevec);
+
+    return CalcMean(timevec, 0, timevec.size() / 2);
+}
+
+static int tsc_invariant( void ) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned eax, ebx, ecx, edx;
+    if (__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)) {
+        return (edx >> 8) & 1;
+    }
+#endif
+    return -1;
+}
+
+const TimerInfo & GetTimerInfo( void ) {
+    static bool      calibrated = false;
+    static TimerInfo info;
+
+    if (calibrated) {
+        return info;
+    }
+
+    double runs[3];
+    for (int i = 0; i < 3; i++) {
+        runs[i] = calibrate_timer(50 * 1000 * 1000);
+    }
+    std::sort(runs, runs + 3);
+    info.ticks_per_ns = runs[1];
+    info.spread       = (runs[2] - runs[0]) / runs[1];
+    info.overhead     = timer_overhead();
+    info.invariant    = tsc_invariant();
+
+    const int         cpu      = GetCurrentCPU();
+    const std::string governor = GetCPUGovernor((cpu < 0) ? 0 : cpu);
+    snprintf(info.governor, sizeof(info.governor), "%s", governor.c_str());
+
+    calibrated = true;
+    return info;
+}
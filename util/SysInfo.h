@@ -0,0 +1,75 @@
+/*
+ * SMHasher3
+ * Copyright (C) 2021-2022  Frank J. T. Wojcik
+ *
+ * This program is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see
+ * <https://www.gnu.org/licenses/>.
+ */
+
+//-----------------------------------------------------------------------------
+// Information about the machine the tests are running on, for tests
+// whose results depend on it.
+
+struct CacheLevel {
+    unsigned  level;
+    uint64_t  size; // in bytes
+};
+
+// The data (or unified) caches visible to CPU 0, innermost first. This
+// is empty if they could not be determined.
+std::vector<CacheLevel> GetDataCaches( void );
+
+// A short name ("L1", "L2", ..., or "DRAM") for the smallest cache
+// level which can hold a working set of the given size, or "?" if the
+// cache sizes are unknown.
+const char * CacheRegime( const std::vector<CacheLevel> & caches, uint64_t bytes );
+
+// The CPUs this process is allowed to run on. This is empty if that
+// could not be determined.
+std::vector<unsigned> GetAllowedCPUs( void );
+
+// Restrict the calling thread to the given CPU, or set of CPUs (like
+// one from GetAllowedCPUs()). Returns false if that is not possible on
+// this system.
+bool PinThreadToCPU( unsigned cpu );
+bool SetThreadCPUs( const std::vector<unsigned> & cpus );
+
+// The CPU the calling thread is running on, or -1 if unknown.
+int GetCurrentCPU( void );
+
+// 1 if the kernel has isolated the given CPU from general scheduling
+// (e.g. with "isolcpus="), 0 if not, or -1 if unknown.
+int IsCPUIsolated( unsigned cpu );
+
+// The given CPU's cpufreq governor (e.g. "performance"), or "" if
+// unknown.
+std::string GetCPUGovernor( unsigned cpu );
+
+// A human-readable CPU model name, or "unknown".
+std::string GetCPUModel( void );
+
+// How the timer_start()/timer_end() counter relates to real time. On
+// x86 that counter is the TSC, which ticks at a fixed rate that may
+// differ from the core clock.
+struct TimerInfo {
+    double  ticks_per_ns;  // measured against the raw monotonic clock
+    double  spread;        // relative spread of the calibration runs
+    double  overhead;      // ticks taken by an empty timer_start()/timer_end() pair
+    int     invariant;     // 1 if the TSC is invariant, 0 if not, -1 if unknown
+    char    governor[32];  // cpufreq governor of the CPU used for calibration, or "" if unknown
+};
+
+// The first call calibrates the timer and measures its overhead, which
+// takes about 150ms.
+const TimerInfo & GetTimerInfo( void );
@@ -20,8 +20,10 @@
 //-----------------------------------------------------------------------------
 // Basic infrastructure that basically all tests use
 #include <vector>
+#include <new>
 #include <cassert>
 #include "Blob.h"
+#include "HugePages.h"
 
 //-----------------------------------------------------------------------------
 // Global variables from main.cpp